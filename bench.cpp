@@ -0,0 +1,480 @@
+// in file: bench.cpp
+//
+// Performance benchmarks for the library: SpMV, BLAS-1 kernels and CG.
+//
+// Build and run:
+//     make bench
+//     ./bench --sizes 1e3,1e4,1e5,1e6 --threads 4 --json bench.json --csv bench.csv
+//
+// Every kernel is run a few times untimed (warmup), then timed --reps times.
+// From the median time we report GFLOP/s and the effective bandwidth in GB/s
+// (bytes the kernel has to move at least once, divided by time), and compare
+// the bandwidth to a STREAM-style triad measured at start-up. For CG we also
+// report iterations per second (problems that fit in cache can exceed the
+// STREAM figure, which is measured out of cache). The JSON/CSV output has one record per
+// (problem, size, kernel) so two builds can be diffed directly.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include "linearAlgebraLib.hpp"
+
+namespace {
+
+// --- Options ---
+
+struct Options {
+    std::vector<size_t> sizes;       // target number of unknowns per problem
+    std::vector<std::string> problems;
+    size_t threads = 1;
+    size_t warmup = 2;
+    size_t reps = 10;
+    size_t cg_iters = 50;            // fixed CG iteration count per timed run
+    size_t stream_size = 1 << 23;    // doubles per STREAM array (64 MB)
+    std::string json_path;
+    std::string csv_path;
+};
+
+void print_usage() {
+    std::cout <<
+        "Usage: bench [options]\n"
+        "  --sizes LIST      comma-separated unknown counts, e.g. 1e3,1e4,1e5 (default 1e3,1e4,1e5,1e6)\n"
+        "  --problems LIST   any of poisson2d,poisson3d,random,banded (default: all)\n"
+        "  --threads N       threads in the global pool (default 1)\n"
+        "  --warmup N        untimed runs per kernel (default 2)\n"
+        "  --reps N          timed runs per kernel (default 10)\n"
+        "  --cg-iters N      CG iterations per timed run (default 50)\n"
+        "  --stream-size N   doubles per STREAM triad array (default 8388608)\n"
+        "  --json FILE       write results as JSON\n"
+        "  --csv FILE        write results as CSV\n";
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) parts.push_back(item);
+    }
+    return parts;
+}
+
+// Accepts plain integers and scientific notation ("1e6")
+size_t parse_count(const std::string& s) {
+    char* end = 0;
+    double value = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || *end != '\0' || value < 1.0) {
+        throw std::invalid_argument("Invalid count: " + s);
+    }
+    return static_cast<size_t>(value + 0.5);
+}
+
+Options parse_options(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--sizes") {
+            std::vector<std::string> parts = split(value, ',');
+            for (size_t k = 0; k < parts.size(); ++k) opt.sizes.push_back(parse_count(parts[k]));
+        } else if (arg == "--problems") {
+            opt.problems = split(value, ',');
+        } else if (arg == "--threads") {
+            opt.threads = parse_count(value);
+        } else if (arg == "--warmup") {
+            opt.warmup = static_cast<size_t>(std::atol(value.c_str()));
+        } else if (arg == "--reps") {
+            opt.reps = parse_count(value);
+        } else if (arg == "--cg-iters") {
+            opt.cg_iters = parse_count(value);
+        } else if (arg == "--stream-size") {
+            opt.stream_size = parse_count(value);
+        } else if (arg == "--json") {
+            opt.json_path = value;
+        } else if (arg == "--csv") {
+            opt.csv_path = value;
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (opt.sizes.empty()) {
+        size_t defaults[] = {1000, 10000, 100000, 1000000};
+        opt.sizes.assign(defaults, defaults + 4);
+    }
+    if (opt.problems.empty()) {
+        const char* all[] = {"poisson2d", "poisson3d", "random", "banded"};
+        opt.problems.assign(all, all + 4);
+    }
+    return opt;
+}
+
+// --- Timing ---
+
+struct Timing {
+    double median; // seconds
+    double min;
+};
+
+// Runs fn() warmup times, then reps timed times
+template <class Fn>
+Timing time_kernel(Fn fn, size_t warmup, size_t reps) {
+    for (size_t i = 0; i < warmup; ++i) fn();
+
+    std::vector<double> samples(reps);
+    for (size_t i = 0; i < reps; ++i) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        samples[i] = std::chrono::duration<double>(stop - start).count();
+    }
+    std::sort(samples.begin(), samples.end());
+    Timing t;
+    t.median = samples[reps / 2];
+    t.min = samples[0];
+    return t;
+}
+
+// --- STREAM-style baseline: a[i] = b[i] + s * c[i] on all pool threads ---
+
+double stream_triad_gbps(const Options& opt) {
+    const size_t n = opt.stream_size;
+    // DoubleArray leaves the elements uninitialized, so no page is touched yet
+    DoubleArray a(n), b(n), c(n);
+    ThreadPool& pool = ThreadPool::global();
+
+    // Each thread touches its own part first (page placement on NUMA systems)
+    pool.run([&](size_t tid, size_t nt) {
+        for (size_t i = n * tid / nt; i < n * (tid + 1) / nt; ++i) {
+            a[i] = 0.0; b[i] = 1.0; c[i] = 2.0;
+        }
+    });
+
+    const double s = 3.0;
+    Timing t = time_kernel([&]() {
+        pool.run([&](size_t tid, size_t nt) {
+            double* pa = &a[0];
+            const double* pb = &b[0];
+            const double* pc = &c[0];
+            for (size_t i = n * tid / nt; i < n * (tid + 1) / nt; ++i) {
+                pa[i] = pb[i] + s * pc[i];
+            }
+        });
+    }, opt.warmup, opt.reps);
+
+    // STREAM convention: best time, 3 arrays of n doubles
+    return 3.0 * n * sizeof(double) / t.min * 1e-9;
+}
+
+// --- Test problems ---
+
+struct Problem {
+    std::string name;
+    SparseMatrix A;
+
+    Problem(const std::string& n, SparseMatrix&& m) : name(n), A(std::move(m)) {}
+};
+
+// Symmetric, strictly diagonally dominant (hence SPD) matrix with
+// about 2 * per_row random off-diagonals per row
+SparseMatrix random_spd_matrix(size_t n, size_t per_row, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    std::uniform_real_distribution<double> value(0.1, 1.0);
+
+    SparseMatrixBuilder builder(n, n);
+    builder.reserve(n * (2 * per_row + 1));
+    std::vector<double> diag(n, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 0; k < per_row; ++k) {
+            size_t j = pick(rng);
+            if (j == i) continue;
+            double v = -value(rng);
+            builder.addValue(i, j, v);
+            builder.addValue(j, i, v);
+            diag[i] -= v;
+            diag[j] -= v;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) builder.addValue(i, i, diag[i]);
+    return builder.build();
+}
+
+// SPD band matrix: -1 on the half_width diagonals on each side, 2 * half_width + 1 on the diagonal
+SparseMatrix banded_matrix(size_t n, size_t half_width) {
+    SparseMatrixBuilder builder(n, n);
+    builder.reserve(n * (2 * half_width + 1));
+    for (size_t i = 0; i < n; ++i) {
+        size_t lo = i >= half_width ? i - half_width : 0;
+        size_t hi = std::min(n - 1, i + half_width);
+        for (size_t j = lo; j <= hi; ++j) {
+            builder.addValue(i, j, j == i ? 2.0 * half_width + 1.0 : -1.0);
+        }
+    }
+    return builder.build();
+}
+
+Problem make_problem(const std::string& name, size_t target) {
+    if (name == "poisson2d") {
+        size_t m = std::max<size_t>(2, static_cast<size_t>(std::sqrt(double(target)) + 0.5));
+        return Problem(name, poisson_matrix_2d(m, m));
+    }
+    if (name == "poisson3d") {
+        size_t m = std::max<size_t>(2, static_cast<size_t>(std::cbrt(double(target)) + 0.5));
+        return Problem(name, poisson_matrix_3d(m, m, m));
+    }
+    if (name == "random") {
+        return Problem(name, random_spd_matrix(target, 3, 12345));
+    }
+    if (name == "banded") {
+        return Problem(name, banded_matrix(target, 4));
+    }
+    throw std::invalid_argument("Unknown problem " + name);
+}
+
+// --- Results ---
+
+struct Record {
+    std::string problem;
+    size_t n;
+    size_t nnz;
+    std::string kernel;
+    Timing time;
+    double gflops;
+    double gbps;
+    double stream_fraction; // gbps / STREAM triad
+    double iters_per_s;     // CG only, 0 otherwise
+};
+
+Record make_record(const Problem& p, const std::string& kernel, const Timing& t,
+                   double flops, double bytes, double stream_gbps, size_t iters = 0) {
+    Record r;
+    r.problem = p.name;
+    r.n = p.A.rows();
+    r.nnz = p.A.nnz();
+    r.kernel = kernel;
+    r.time = t;
+    r.gflops = flops / t.median * 1e-9;
+    r.gbps = bytes / t.median * 1e-9;
+    r.stream_fraction = r.gbps / stream_gbps;
+    r.iters_per_s = iters ? iters / t.median : 0.0;
+    return r;
+}
+
+void run_problem(const Problem& p, const Options& opt, double stream_gbps, std::vector<Record>& out) {
+    const SparseMatrix& A = p.A;
+    const double n = static_cast<double>(A.rows());
+    const double nnz = static_cast<double>(A.nnz());
+    const double word = sizeof(double);
+    const double index = sizeof(size_t);
+
+    Vector x(A.cols()), y(A.rows()), w(A.rows());
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = 1.0 + 0.5 * std::sin(0.1 * i);
+        y[i] = 1.0 - 0.5 * std::cos(0.1 * i);
+    }
+
+    // SpMV: values + column indices + row offsets + x + y
+    const double spmv_bytes = nnz * (word + index) + (n + 1) * index + 2.0 * n * word;
+    Timing t = time_kernel([&]() { A.multiply(x, w); }, opt.warmup, opt.reps);
+    out.push_back(make_record(p, "spmv", t, 2.0 * nnz, spmv_bytes, stream_gbps));
+
+    // The operator form allocates its result every call
+    t = time_kernel([&]() { Vector r = A * x; (void)r; }, opt.warmup, opt.reps);
+    out.push_back(make_record(p, "spmv_operator", t, 2.0 * nnz, spmv_bytes, stream_gbps));
+
+    // Float values with 32-bit indices (the inner SpMV of MixedPrecisionCG)
+    {
+        CompactCsrMatrix<float, uint32_t> Af(A);
+        std::vector<float> xf(x.data(), x.data() + x.size()), wf(A.rows());
+        t = time_kernel([&]() { Af.multiply(&xf[0], &wf[0]); }, opt.warmup, opt.reps);
+        out.push_back(make_record(p, "spmv_float32", t, 2.0 * nnz,
+                                  nnz * 8.0 + (n + 1) * 4.0 + 2.0 * n * 4.0, stream_gbps));
+    }
+
+    // Compressed indices: 32-bit column indices, then per-row delta encoding
+    {
+        CompactCsrMatrix<double, uint32_t> A32(A);
+        t = time_kernel([&]() { A32.multiply(x, w); }, opt.warmup, opt.reps);
+        out.push_back(make_record(p, "spmv_index32", t, 2.0 * nnz,
+                                  nnz * (word + 4.0) + (n + 1) * 4.0 + 2.0 * n * word, stream_gbps));
+
+        DeltaCsrMatrix Ad(A);
+        t = time_kernel([&]() { Ad.multiply(x, w); }, opt.warmup, opt.reps);
+        out.push_back(make_record(p, "spmv_delta", t, 2.0 * nnz,
+                                  static_cast<double>(Ad.valueBytes() + Ad.indexBytes()) + 2.0 * n * word,
+                                  stream_gbps));
+    }
+
+    // SpMM with 8 columns: the matrix is read once, X and Y are 8 times wider.
+    // Flops count all 8 products so the rate compares directly with spmv.
+    {
+        const size_t k = 8;
+        MultiVector X(A.cols(), k), Y(A.rows(), k);
+        for (size_t i = 0; i < A.cols(); ++i) {
+            for (size_t j = 0; j < k; ++j) X.row(i)[j] = x[i] + 0.01 * j;
+        }
+        t = time_kernel([&]() { A.multiplyBlock(X, Y); }, opt.warmup, opt.reps);
+        out.push_back(make_record(p, "spmm_k8", t, 2.0 * nnz * k,
+                                  nnz * (word + index) + (n + 1) * index + 2.0 * n * k * word, stream_gbps));
+    }
+
+    // Symmetric storage: diagonal + upper triangle, y read and written once more
+    {
+        SymmetricSparseMatrix As(A);
+        const double upper = static_cast<double>(As.nnz());
+        t = time_kernel([&]() { As.multiply(x, w); }, opt.warmup, opt.reps);
+        out.push_back(make_record(p, "spmv_symmetric", t, 2.0 * nnz,
+                                  upper * (word + index) + (n + 1) * index + 3.0 * n * word, stream_gbps));
+    }
+
+    // SpMV after reverse Cuthill-McKee renumbering (same matrix, better x locality)
+    {
+        SparseMatrix Ar = permute_symmetric(A, reverse_cuthill_mckee(A));
+        t = time_kernel([&]() { Ar.multiply(x, w); }, opt.warmup, opt.reps);
+        out.push_back(make_record(p, "spmv_rcm", t, 2.0 * nnz, spmv_bytes, stream_gbps));
+    }
+
+    volatile double sink = 0.0;
+    t = time_kernel([&]() { sink = dot_product(x, y); }, opt.warmup, opt.reps);
+    out.push_back(make_record(p, "dot", t, 2.0 * n, 2.0 * n * word, stream_gbps));
+
+    t = time_kernel([&]() { sink = norm(x); }, opt.warmup, opt.reps);
+    out.push_back(make_record(p, "norm", t, 2.0 * n, n * word, stream_gbps));
+
+    t = time_kernel([&]() { w.axpy(1e-3, x); }, opt.warmup, opt.reps);
+    out.push_back(make_record(p, "axpy", t, 2.0 * n, 3.0 * n * word, stream_gbps));
+
+    // Expression template: one fused loop, no temporaries
+    t = time_kernel([&]() { w = x + 2.0 * y; }, opt.warmup, opt.reps);
+    out.push_back(make_record(p, "vector_expr", t, 2.0 * n, 3.0 * n * word, stream_gbps));
+    (void)sink;
+
+    // CG with a fixed iteration count (tolerance 0 never converges early).
+    // Per iteration: one SpMV, p.Ap, axpy, fused axpy+dot, xpay.
+    Vector b(A.rows());
+    A.multiply(x, b);
+    Vector sol(A.cols());
+    CGWorkspace ws;
+    t = time_kernel([&]() {
+        sol.scale(0.0);
+        solve_cg(A, b, sol, opt.cg_iters, 0.0, ws);
+    }, opt.warmup > 0 ? 1 : 0, opt.reps);
+    const double iters = static_cast<double>(opt.cg_iters);
+    const double cg_flops = iters * (2.0 * nnz + 10.0 * n);
+    const double cg_bytes = iters * (spmv_bytes + 11.0 * n * word);
+    out.push_back(make_record(p, "cg", t, cg_flops, cg_bytes, stream_gbps, opt.cg_iters));
+
+    // Pipelined and s-step variants, charged with the classic CG work above so
+    // the rates compare time per iteration directly (both do extra work per iteration)
+    const char* variant_names[] = {"cg_pipelined", "cg_sstep4"};
+    const CGVariant variants[] = {CGVariant::Pipelined, CGVariant::SStep};
+    for (size_t v = 0; v < 2; ++v) {
+        CGVariantOptions options;
+        options.variant = variants[v];
+        options.s = 4;
+        t = time_kernel([&]() {
+            sol.scale(0.0);
+            solve_cg(A, b, sol, opt.cg_iters, 0.0, ws, options);
+        }, opt.warmup > 0 ? 1 : 0, opt.reps);
+        out.push_back(make_record(p, variant_names[v], t, cg_flops, cg_bytes, stream_gbps, opt.cg_iters));
+    }
+}
+
+// --- Output ---
+
+void print_table(const std::vector<Record>& records) {
+    std::cout << std::left;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        std::ostringstream line;
+        line.setf(std::ios::fixed);
+        line.precision(3);
+        line << r.problem << " n=" << r.n << " " << r.kernel
+             << ": " << r.time.median * 1e3 << " ms, "
+             << r.gflops << " GFLOP/s, " << r.gbps << " GB/s ("
+             << 100.0 * r.stream_fraction << "% of STREAM)";
+        if (r.iters_per_s > 0.0) line << ", " << r.iters_per_s << " it/s";
+        std::cout << line.str() << std::endl;
+    }
+}
+
+void write_csv(const std::string& path, const std::vector<Record>& records, size_t threads, double stream_gbps) {
+    std::ofstream f(path.c_str());
+    if (!f) throw std::runtime_error("Cannot open " + path);
+    f.precision(9);
+    f << "problem,n,nnz,kernel,threads,time_median_s,time_min_s,gflops,gbps,stream_gbps,stream_fraction,iters_per_s\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        f << r.problem << ',' << r.n << ',' << r.nnz << ',' << r.kernel << ',' << threads << ','
+          << r.time.median << ',' << r.time.min << ',' << r.gflops << ',' << r.gbps << ','
+          << stream_gbps << ',' << r.stream_fraction << ',' << r.iters_per_s << '\n';
+    }
+}
+
+void write_json(const std::string& path, const std::vector<Record>& records, const Options& opt, double stream_gbps) {
+    std::ofstream f(path.c_str());
+    if (!f) throw std::runtime_error("Cannot open " + path);
+    f.precision(9);
+    f << "{\n"
+      << "  \"threads\": " << opt.threads << ",\n"
+      << "  \"warmup\": " << opt.warmup << ",\n"
+      << "  \"reps\": " << opt.reps << ",\n"
+      << "  \"cg_iters\": " << opt.cg_iters << ",\n"
+      << "  \"stream_triad_gbps\": " << stream_gbps << ",\n"
+      << "  \"results\": [\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        f << "    {\"problem\": \"" << r.problem << "\", \"n\": " << r.n << ", \"nnz\": " << r.nnz
+          << ", \"kernel\": \"" << r.kernel << "\", \"time_median_s\": " << r.time.median
+          << ", \"time_min_s\": " << r.time.min << ", \"gflops\": " << r.gflops
+          << ", \"gbps\": " << r.gbps << ", \"stream_fraction\": " << r.stream_fraction
+          << ", \"iters_per_s\": " << r.iters_per_s << "}"
+          << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    f << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opt = parse_options(argc, argv);
+        set_num_threads(opt.threads);
+
+        double stream_gbps = stream_triad_gbps(opt);
+        std::cout << "--- Benchmarks: " << opt.threads << " thread(s), STREAM triad "
+                  << stream_gbps << " GB/s ---" << std::endl;
+
+        std::vector<Record> records;
+        for (size_t s = 0; s < opt.sizes.size(); ++s) {
+            for (size_t q = 0; q < opt.problems.size(); ++q) {
+                Problem p = make_problem(opt.problems[q], opt.sizes[s]);
+                size_t first = records.size();
+                run_problem(p, opt, stream_gbps, records);
+                print_table(std::vector<Record>(records.begin() + first, records.end()));
+            }
+        }
+
+        if (!opt.csv_path.empty()) write_csv(opt.csv_path, records, opt.threads, stream_gbps);
+        if (!opt.json_path.empty()) write_json(opt.json_path, records, opt, stream_gbps);
+    } catch (const std::exception& e) {
+        std::cerr << "An error occurred: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
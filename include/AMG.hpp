@@ -0,0 +1,126 @@
+// in file: include/AMG.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <ostream>
+#include "SparseMatrix.hpp"
+#include "Preconditioner.hpp"
+#include "vector.hpp"
+
+/**
+ * @class AMGHierarchy
+ * @brief Smoothed-aggregation algebraic multigrid (SA-AMG).
+ *
+ * Setup builds a hierarchy of ever smaller matrices from A alone (no mesh needed):
+ *   1. Strength of connection: j is a strong neighbour of i if
+ *      |a_ij| >= theta * sqrt(|a_ii * a_jj|).
+ *   2. Aggregation: strongly connected nodes are grouped into aggregates,
+ *      each aggregate becomes one coarse unknown.
+ *   3. Prolongation: the piecewise-constant tentative prolongator is smoothed
+ *      with one damped Jacobi step on the filtered matrix, P = (I - w D^-1 A_F) P0.
+ *   4. Galerkin product: A_coarse = P^T A P (SparseMatrix::transpose and SpGEMM).
+ * The coarsest level is solved exactly with a dense Cholesky factorization
+ * if it has at most max(coarse_size, kMaxDenseCoarseRows) rows. A larger
+ * coarsest level (coarsening stalled, e.g. on a diagonal or weakly coupled
+ * matrix, or max_levels was reached) is only smoothed, with
+ * kCoarseSmoothingSweeps sweeps of the level smoother, so that setup never
+ * needs O(n^2) memory or O(n^3) time.
+ *
+ * The hierarchy can be used as a standalone V-cycle solver (solve) or as a
+ * preconditioner in solve_pcg (one V-cycle per apply). Setup and solve
+ * times are recorded per level; see levelStats() and printStatistics().
+ *
+ * The fine matrix is referenced, not copied, so A must outlive the hierarchy.
+ */
+class AMGHierarchy : public Preconditioner {
+public:
+    enum Smoother { Jacobi, Chebyshev };
+
+    // Largest coarsest level factorized densely (unless coarse_size is larger)
+    static const size_t kMaxDenseCoarseRows = 2000;
+    // Smoother sweeps replacing the exact solve on a larger coarsest level
+    static const size_t kCoarseSmoothingSweeps = 10;
+
+    struct Options {
+        double strength_threshold;  // theta in the strength test
+        size_t max_levels;          // including the finest level
+        size_t coarse_size;         // stop coarsening at or below this many rows
+        Smoother smoother;
+        size_t smoothing_steps;     // pre- and post-smoothing sweeps (Jacobi)
+        size_t chebyshev_degree;    // polynomial degree (Chebyshev)
+        double jacobi_weight;       // damping of the Jacobi smoother
+
+        Options()
+            : strength_threshold(0.08), max_levels(10), coarse_size(100),
+              smoother(Chebyshev), smoothing_steps(1), chebyshev_degree(2),
+              jacobi_weight(2.0 / 3.0) {}
+    };
+
+    // Size and timing information of one level
+    struct LevelStats {
+        size_t rows;
+        size_t nnz;
+        double setup_seconds;   // time spent building this level's transfer operators and coarse matrix
+        double solve_seconds;   // time spent on this level during V-cycles (excluding coarser levels)
+        size_t cycles;          // number of times this level was visited
+    };
+
+    explicit AMGHierarchy(const SparseMatrix& A, const Options& options = Options());
+
+    /**
+     * @brief Performs one V-cycle on A x = b, improving x in place.
+     */
+    void vcycle(const Vector& b, Vector& x) const;
+
+    /**
+     * @brief Standalone solver: repeats V-cycles until ||b - A x|| < tolerance * ||b||.
+     * @return The number of V-cycles performed (max_iter if it did not converge).
+     */
+    size_t solve(const Vector& b, Vector& x, size_t max_iter, double tolerance) const;
+
+    /**
+     * @brief Preconditioner interface: z = one V-cycle applied to r starting from zero.
+     */
+    void apply(const Vector& r, Vector& z) const;
+
+    size_t numLevels() const { return m_levels.size(); }
+    const std::vector<LevelStats>& levelStats() const { return m_stats; }
+
+    // Grid complexity / operator complexity: total rows (nnz) over fine rows (nnz)
+    double operatorComplexity() const;
+
+    // Clears the accumulated solve times (setup times are kept)
+    void resetSolveTimes() const;
+
+    // Prints one line per level with sizes, setup and solve times
+    void printStatistics(std::ostream& out) const;
+
+private:
+    struct Level {
+        const SparseMatrix* A;           // operator on this level
+        SparseMatrix P;                  // prolongation to this level from the next coarser one
+        SparseMatrix R;                  // restriction, R = P^T
+        std::vector<double> inv_diag;    // 1 / a_ii, used by the smoothers
+        double lambda_max;               // estimate of the largest eigenvalue of D^-1 A
+
+        // Scratch space so a V-cycle does not allocate
+        mutable Vector residual;
+        mutable Vector correction;
+        mutable Vector coarse_rhs;
+        mutable Vector coarse_x;
+
+        Level() : A(0), P(0, 0, 0), R(0, 0, 0), lambda_max(0.0) {}
+    };
+
+    void cycle(size_t level, const Vector& b, Vector& x) const;
+    void smooth(const Level& level, const Vector& b, Vector& x) const;
+    void coarseSolve(const Vector& b, Vector& x) const;
+
+    Options m_options;
+    std::vector<Level> m_levels;
+    std::vector<SparseMatrix> m_coarse_matrices; // owns A for levels 1..L-1
+    std::vector<double> m_coarse_cholesky;       // dense L of the coarsest matrix (row-major)
+    size_t m_coarse_n;                           // 0: coarsest level is smoothed, not factorized
+    mutable std::vector<LevelStats> m_stats;
+};
@@ -0,0 +1,125 @@
+// in file: include/BatchSolver.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <exception>
+#include "LinearOperator.hpp"
+#include "Preconditioner.hpp"
+#include "vector.hpp"
+#include "cfd.hpp"
+
+// One independent system A x = b for BatchSolver
+struct BatchJob {
+    const LinearOperator* A = nullptr; // must stay alive until the job has completed
+    const Preconditioner* M = nullptr; // optional; solve_pcg if set, solve_cg otherwise
+    Vector b;
+    Vector x0;                         // initial guess; empty means zero
+    double tolerance = 1e-8;
+    size_t max_iter = 1000;
+};
+
+struct BatchResult {
+    Vector x;
+    SolveReport report;
+    std::exception_ptr error; // callback form only: set if the solve threw
+};
+
+struct BatchSolverOptions {
+    size_t num_threads = 0;         // worker threads; 0 = one per hardware thread
+    size_t large_job_rows = 100000; // jobs with at least this many rows are "large"
+};
+
+/**
+ * @class BatchSolver
+ * @brief Runs many independent CG / PCG solves concurrently.
+ *
+ * A parameter study produces thousands of systems that are each too small
+ * for the data-parallel kernels to pay off, so instead whole solves are
+ * spread over the cores:
+ *   - every worker thread has its own job deque; submit() deals jobs out
+ *     round-robin, a worker takes its own newest job first and, when its
+ *     deque is empty, steals the oldest job of another worker, so uneven
+ *     job sizes even out;
+ *   - small jobs run with SerialKernelScope: their kernels stay on the
+ *     worker instead of competing for the global ThreadPool;
+ *   - a large job (at least large_job_rows rows) gets intra-solve
+ *     parallelism instead: workers stop starting new jobs, and once the
+ *     running ones have finished the large job runs alone, its kernels
+ *     threaded on the global ThreadPool (sized by set_num_threads). When
+ *     the global pool has one thread every job is treated as small.
+ *
+ * Each job reports back either through a std::future or a callback (called
+ * on the worker thread; it must not throw or block on other jobs of the
+ * same batch).
+ * Operators and preconditioners may be shared between jobs as long as
+ * their multiply() / apply() are safe to call concurrently (SparseMatrix,
+ * Jacobi, SSOR and IC(0) are; AMGHierarchy records statistics and
+ * ChebyshevPreconditioner keeps work vectors, so they are not).
+ */
+class BatchSolver {
+public:
+    typedef std::function<void(const BatchResult&)> Callback;
+
+    explicit BatchSolver(const BatchSolverOptions& options = BatchSolverOptions());
+
+    // Waits for all submitted jobs, then joins the workers
+    ~BatchSolver();
+
+    BatchSolver(const BatchSolver&) = delete;
+    BatchSolver& operator=(const BatchSolver&) = delete;
+
+    size_t numThreads() const { return m_workers.size(); }
+
+    // Queues a job; the future yields the result or rethrows the solve's exception
+    std::future<BatchResult> submit(BatchJob job);
+
+    // Queues a job; on_done receives the result (with error set if the solve threw)
+    void submit(BatchJob job, Callback on_done);
+
+    // Submits all jobs and waits for them; rethrows the first exception, if any
+    std::vector<BatchResult> solveAll(std::vector<BatchJob> jobs);
+
+    // Blocks until every job submitted so far has completed
+    void wait();
+
+private:
+    struct Task {
+        BatchJob job;
+        std::promise<BatchResult> promise;
+        Callback on_done;
+    };
+
+    // A worker's deque: the owner pops from the back, thieves from the front
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task*> tasks;
+    };
+
+    void enqueue(Task* task);
+    Task* takeSmall(size_t worker);
+    void workerLoop(size_t worker);
+    void execute(Task* task, CGWorkspace& workspace);
+
+    BatchSolverOptions m_options;
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkerQueue> > m_queues;
+
+    std::mutex m_mutex;                 // Protects everything below
+    std::condition_variable m_wake;     // Workers: work available or state changed
+    std::condition_variable m_idle;     // wait(): outstanding reached zero
+    std::deque<Task*> m_large;          // Large jobs, run one at a time in FIFO order
+    size_t m_small_queued;              // Small jobs in the deques not yet claimed
+    size_t m_running;                   // Jobs currently executing
+    bool m_exclusive;                   // A large job is running
+    size_t m_outstanding;               // Submitted and not yet completed
+    size_t m_next_queue;                // Round-robin target of submit()
+    bool m_stop;
+};
@@ -0,0 +1,44 @@
+// in file: include/BlockCG.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "LinearOperator.hpp"
+#include "MultiVector.hpp"
+#include "cfd.hpp"
+
+// Result of a block solve: one entry per right-hand side in the per-column vectors
+struct BlockSolveReport {
+    size_t iterations = 0;                  // block iterations (= block products A * P)
+    std::vector<size_t> column_iterations;  // iterations each column needed
+    std::vector<ConvergenceReason> reasons; // why each column stopped
+    std::vector<double> final_residuals;    // ||b_j - A x_j|| estimate when each column stopped
+    size_t fallback_columns = 0;            // columns finished by single-vector CG (see below)
+
+    double time_spmm = 0.0;    // block products
+    double time_dot = 0.0;     // block inner products (k x k Gram matrices)
+    double time_update = 0.0;  // block vector updates and small dense solves
+    double time_total = 0.0;
+
+    bool converged() const;
+};
+
+/**
+ * @brief Block Conjugate Gradient (O'Leary, 1980) for A X = B with k right-hand sides.
+ *
+ * All k columns are iterated together: every iteration does ONE block product
+ * Q = A P (for a SparseMatrix that is an SpMM reading the matrix once for all
+ * columns) and two k x k Gram matrices, and the step sizes alpha and beta
+ * become small k x k matrices. Each column also gains the search directions
+ * of the others, so a block needs fewer iterations than one CG per column.
+ *
+ * Deflation: a column whose residual reaches tolerance * ||b_j|| is removed
+ * from the block, so the remaining iterations only work on active columns.
+ * If the active residuals become linearly dependent (the k x k systems lose
+ * positive definiteness) the offending column is dropped from the block and
+ * finished afterwards with solve_cg; fallback_columns counts those.
+ *
+ * @param X Initial guesses on entry, solutions on exit (A.cols() x k).
+ */
+BlockSolveReport solve_block_cg(const LinearOperator& A, const MultiVector& B, MultiVector& X,
+                                size_t max_iter, double tolerance);
@@ -0,0 +1,323 @@
+// in file: include/BsrMatrix.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm> // For std::sort, std::lower_bound
+#include <cmath>     // For std::fabs
+#include "SparseMatrix.hpp"
+#include "LinearOperator.hpp"
+#include "Preconditioner.hpp"
+#include "ThreadPool.hpp"
+#include "CpuFeatures.hpp"
+#include "Memory.hpp"
+#include "vector.hpp"
+
+namespace bsr_detail {
+
+// Unroll<N>::run(f) calls f(0), f(1), ..., f(N - 1) with no loop left after inlining
+template <size_t N>
+struct Unroll {
+    template <class F>
+    static inline void run(const F& f) {
+        Unroll<N - 1>::run(f);
+        f(N - 1);
+    }
+};
+
+template <>
+struct Unroll<0> {
+    template <class F>
+    static inline void run(const F&) {}
+};
+
+// acc += a * x for one B x B block stored column by column.
+// Column c adds a(:, c) * x_c to all B rows: a vector multiply-add per column.
+template <size_t B>
+inline void block_multiply_add(const double* a, const double* x, double* acc) {
+    Unroll<B>::run([&](size_t c) {
+        const double xc = x[c];
+        Unroll<B>::run([&](size_t r) { acc[r] += a[c * B + r] * xc; });
+    });
+}
+
+} // namespace bsr_detail
+
+// AVX2 kernel for 4x4 blocks: block rows [row_begin, row_end) of y = A * x
+// (defined in src/BsrMatrix.cpp; same rounding as the portable kernel)
+void bsr4_multiply_avx2(size_t row_begin, size_t row_end,
+                        const size_t* row_offsets, const size_t* col_indices, const double* values,
+                        const double* x, double* y);
+
+/**
+ * @class BsrMatrix
+ * @brief Block CSR: a sparse matrix of dense B x B blocks.
+ *
+ * Coupled fields (velocity components and pressure, several species) give
+ * a small dense block at every mesh connection. CSR stores one 8-byte
+ * column index per scalar; BSR stores one per block, B*B times fewer, and
+ * each block is multiplied by a fully unrolled micro-kernel that keeps the
+ * B partial sums of a block row in registers. The block size is a template
+ * parameter (typically 2-5), so every loop over a block has a fixed length.
+ *
+ * Blocks are stored column by column. The portable kernel is written so
+ * the compiler can turn each block column into vector operations; for
+ * B = 4 an explicit AVX2 kernel (one 256-bit multiply-add per block column)
+ * is selected at run time when the CPU supports it. Both round identically.
+ *
+ * Converted from a SparseMatrix whose dimensions are multiples of B; scalar
+ * entries missing from a stored block become explicit zeros.
+ */
+template <size_t B>
+class BsrMatrix : public LinearOperator {
+public:
+    static const size_t kBlockSize = B;
+    static const size_t kBlockEntries = B * B;
+
+    // Which SpMV implementation multiply() uses
+    enum Kernel { Scalar, AVX2 };
+
+    /**
+     * @brief Groups the entries of A into B x B blocks.
+     * @throws std::invalid_argument if rows or columns are not multiples of B.
+     */
+    explicit BsrMatrix(const SparseMatrix& A)
+        : m_block_rows(A.rows() / B), m_block_cols(A.cols() / B), m_kernel(Scalar) {
+        if (B == 0 || A.rows() % B != 0 || A.cols() % B != 0) {
+            throw std::invalid_argument("Matrix dimensions must be multiples of the block size");
+        }
+        const IndexArray& row_offsets = A.rowOffsets();
+        const IndexArray& col_indices = A.colIndices();
+        const DoubleArray& values = A.values();
+
+        // 1. Block pattern: the distinct block columns of each block row, sorted
+        std::vector<size_t> last_row(m_block_cols, static_cast<size_t>(-1));
+        m_row_offsets.assign(m_block_rows + 1, 0);
+        for (size_t I = 0; I < m_block_rows; ++I) {
+            const size_t first = m_col_indices.size();
+            for (size_t i = I * B; i < (I + 1) * B; ++i) {
+                for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+                    const size_t J = col_indices[k] / B;
+                    if (last_row[J] != I) {
+                        last_row[J] = I;
+                        m_col_indices.push_back(J);
+                    }
+                }
+            }
+            std::sort(m_col_indices.begin() + first, m_col_indices.end());
+            m_row_offsets[I + 1] = m_col_indices.size();
+        }
+
+        // 2. Scatter the scalars into their blocks (duplicates are summed)
+        m_values.assign(m_col_indices.size() * kBlockEntries, 0.0);
+        for (size_t I = 0; I < m_block_rows; ++I) {
+            const size_t* first = m_col_indices.data() + m_row_offsets[I];
+            const size_t* last = m_col_indices.data() + m_row_offsets[I + 1];
+            for (size_t i = I * B; i < (I + 1) * B; ++i) {
+                for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+                    const size_t J = col_indices[k] / B;
+                    const size_t block = std::lower_bound(first, last, J) - m_col_indices.data();
+                    m_values[block * kBlockEntries + (col_indices[k] % B) * B + (i % B)] += values[k];
+                }
+            }
+        }
+
+        if (B == 4 && cpu_has_avx2()) {
+            m_kernel = AVX2;
+        }
+    }
+
+    size_t rows() const { return m_block_rows * B; }
+    size_t cols() const { return m_block_cols * B; }
+    size_t blockRows() const { return m_block_rows; }
+    size_t blockCols() const { return m_block_cols; }
+
+    // Stored blocks, and stored scalars (including the explicit zeros inside blocks)
+    size_t numBlocks() const { return m_col_indices.size(); }
+    size_t nnz() const { return m_values.size(); }
+
+    // Block pattern (in blocks) and block values (kBlockEntries per block, column-major)
+    const DoubleArray& values() const { return m_values; }
+    const IndexArray& colIndices() const { return m_col_indices; }
+    const IndexArray& rowOffsets() const { return m_row_offsets; }
+
+    // y = A * x; threaded over nnz-balanced ranges of block rows
+    void multiply(const Vector& x, Vector& y) const {
+        if (x.size() != cols()) {
+            throw std::length_error("Matrix column count must match Vector size");
+        }
+        if (y.size() != rows()) {
+            throw std::length_error("Result Vector size must match Matrix row count");
+        }
+        const double* px = x.data();
+        double* py = y.data();
+        ThreadPool& pool = ThreadPool::global();
+        if (pool.size() == 1 || nnz() < kParallelMinWork) {
+            multiplyRows(0, m_block_rows, px, py);
+            return;
+        }
+        pool.run([&](size_t tid, size_t num_threads) {
+            multiplyRows(rowBound(tid, num_threads), rowBound(tid + 1, num_threads), px, py);
+        });
+    }
+
+    Vector operator*(const Vector& x) const {
+        Vector result(rows());
+        multiply(x, result);
+        return result;
+    }
+
+    Kernel kernel() const { return m_kernel; }
+
+    // AVX2 is available for B = 4 on CPUs that support it; throws std::runtime_error otherwise
+    void setKernel(Kernel kernel) {
+        if (kernel == AVX2 && (B != 4 || !cpu_has_avx2())) {
+            throw std::runtime_error("Requested SIMD kernel is not supported for this block size or CPU");
+        }
+        m_kernel = kernel;
+    }
+
+private:
+    void multiplyRows(size_t row_begin, size_t row_end, const double* x, double* y) const {
+        if (m_kernel == AVX2) {
+            bsr4_multiply_avx2(row_begin, row_end, m_row_offsets.data(), m_col_indices.data(),
+                               m_values.data(), x, y);
+            return;
+        }
+        const size_t* offsets = m_row_offsets.data();
+        const size_t* cols = m_col_indices.data();
+        const double* vals = m_values.data();
+        for (size_t I = row_begin; I < row_end; ++I) {
+            double acc[B] = {};
+            for (size_t k = offsets[I]; k < offsets[I + 1]; ++k) {
+                bsr_detail::block_multiply_add<B>(vals + k * kBlockEntries, x + cols[k] * B, acc);
+            }
+            bsr_detail::Unroll<B>::run([&](size_t r) { y[I * B + r] = acc[r]; });
+        }
+    }
+
+    // First block row of part p out of num_parts, each holding ~numBlocks / num_parts blocks
+    size_t rowBound(size_t p, size_t num_parts) const {
+        if (p >= num_parts) {
+            return m_block_rows;
+        }
+        size_t target = static_cast<size_t>((static_cast<double>(numBlocks()) * p) / num_parts);
+        return std::lower_bound(m_row_offsets.begin(), m_row_offsets.end(), target) - m_row_offsets.begin();
+    }
+
+    size_t m_block_rows;
+    size_t m_block_cols;
+    DoubleArray m_values;
+    IndexArray m_col_indices;
+    IndexArray m_row_offsets;
+    Kernel m_kernel;
+};
+
+template <size_t B>
+const size_t BsrMatrix<B>::kBlockSize;
+template <size_t B>
+const size_t BsrMatrix<B>::kBlockEntries;
+
+/**
+ * @class BlockJacobiPreconditioner
+ * @brief M = block diagonal of A (the B x B blocks on the diagonal).
+ *
+ * The natural Jacobi for coupled fields: each block couples the unknowns
+ * of one mesh point, so inverting it removes the coupling that a scalar
+ * diagonal ignores. The inverses are computed once (Gauss-Jordan with
+ * partial pivoting) and apply() is one unrolled block product per block
+ * row. Works with solve_pcg for a BsrMatrix or the equivalent SparseMatrix.
+ */
+template <size_t B>
+class BlockJacobiPreconditioner : public Preconditioner {
+public:
+    // Throws std::runtime_error if a diagonal block is missing or singular
+    explicit BlockJacobiPreconditioner(const BsrMatrix<B>& A) {
+        setBlocks(A);
+    }
+
+    explicit BlockJacobiPreconditioner(const SparseMatrix& A) {
+        updateValues(A);
+    }
+
+    // z_I = D_I^-1 r_I for every block row I
+    void apply(const Vector& r, Vector& z) const {
+        const size_t n = m_inv_blocks.size() / B;
+        if (r.size() != n || z.size() != n) {
+            throw std::length_error("Preconditioner and Vector sizes must match");
+        }
+        const double* pr = r.data();
+        double* pz = z.data();
+        const double* inv = m_inv_blocks.data();
+        for (size_t I = 0; I < n / B; ++I) {
+            double acc[B] = {};
+            bsr_detail::block_multiply_add<B>(inv + I * B * B, pr + I * B, acc);
+            bsr_detail::Unroll<B>::run([&](size_t r) { pz[I * B + r] = acc[r]; });
+        }
+    }
+
+    void updateValues(const SparseMatrix& A) {
+        if (A.rows() != A.cols()) {
+            throw std::invalid_argument("Preconditioner requires a square matrix");
+        }
+        setBlocks(BsrMatrix<B>(A));
+    }
+
+private:
+    void setBlocks(const BsrMatrix<B>& A) {
+        if (A.rows() != A.cols()) {
+            throw std::invalid_argument("Preconditioner requires a square matrix");
+        }
+        const size_t nb = A.blockRows();
+        const IndexArray& offsets = A.rowOffsets();
+        const IndexArray& cols = A.colIndices();
+        m_inv_blocks.assign(nb * B * B, 0.0);
+        for (size_t I = 0; I < nb; ++I) {
+            const size_t* first = cols.data() + offsets[I];
+            const size_t* last = cols.data() + offsets[I + 1];
+            const size_t* diag = std::lower_bound(first, last, I);
+            if (diag == last || *diag != I) {
+                throw std::runtime_error("Block Jacobi requires every diagonal block");
+            }
+            invert(A.values().data() + (diag - cols.data()) * B * B, m_inv_blocks.data() + I * B * B);
+        }
+    }
+
+    // inv = a^-1 for column-major B x B blocks (Gauss-Jordan, partial pivoting)
+    static void invert(const double* a, double* inv) {
+        double m[B][2 * B]; // row r: [a(r, :) | I(r, :)]
+        for (size_t r = 0; r < B; ++r) {
+            for (size_t c = 0; c < B; ++c) {
+                m[r][c] = a[c * B + r];
+                m[r][B + c] = (r == c) ? 1.0 : 0.0;
+            }
+        }
+        for (size_t c = 0; c < B; ++c) {
+            size_t pivot = c;
+            for (size_t r = c + 1; r < B; ++r) {
+                if (std::fabs(m[r][c]) > std::fabs(m[pivot][c])) pivot = r;
+            }
+            if (m[pivot][c] == 0.0) {
+                throw std::runtime_error("Block Jacobi: singular diagonal block");
+            }
+            if (pivot != c) {
+                for (size_t k = 0; k < 2 * B; ++k) std::swap(m[c][k], m[pivot][k]);
+            }
+            const double scale = 1.0 / m[c][c];
+            for (size_t k = 0; k < 2 * B; ++k) m[c][k] *= scale;
+            for (size_t r = 0; r < B; ++r) {
+                if (r == c || m[r][c] == 0.0) continue;
+                const double f = m[r][c];
+                for (size_t k = 0; k < 2 * B; ++k) m[r][k] -= f * m[c][k];
+            }
+        }
+        for (size_t r = 0; r < B; ++r) {
+            for (size_t c = 0; c < B; ++c) {
+                inv[c * B + r] = m[r][B + c];
+            }
+        }
+    }
+
+    std::vector<double> m_inv_blocks; // D_I^-1, column-major, B * B per block row
+};
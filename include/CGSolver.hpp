@@ -0,0 +1,105 @@
+// in file: include/CGSolver.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <memory>
+#include "SparseMatrix.hpp"
+#include "Preconditioner.hpp"
+#include "vector.hpp"
+#include "cfd.hpp"
+
+// Preconditioners CGSolver can build and refresh itself
+enum class PreconditionerType { None, Jacobi, SSOR, IC0 };
+
+struct CGSolverOptions {
+    size_t max_iter = 1000;
+    double tolerance = 1e-8;
+    PreconditionerType preconditioner = PreconditionerType::None;
+    double ssor_omega = 1.0;
+};
+
+/**
+ * @class CGSolver
+ * @brief A persistent CG / PCG solver for a sequence of systems that share one
+ * sparsity pattern (time stepping, Newton iterations).
+ *
+ * Rebuilding a SparseMatrix and calling solve_cg every step repeats the
+ * assembly of the pattern, the workspace allocation and the symbolic setup of
+ * the preconditioner. CGSolver owns the matrix and keeps all of that:
+ *   - the pattern is fixed at construction; coefficients change in place
+ *     through slots (slot(row, col) looks an entry up once, setValue /
+ *     addValue write it) or wholesale with setValues();
+ *   - the preconditioner keeps its symbolic setup (for IC(0): the factor
+ *     pattern and level schedules) and is refactored numerically, once, on
+ *     the first solve after the values changed (or explicitly with refresh());
+ *   - the workspace vectors are allocated by the first solve only;
+ *   - solve(b) starts from the previous solution (warm start), which after a
+ *     small time step is already close to the new one.
+ * A step then costs the value updates, one numeric refactorization and the
+ * CG iterations.
+ */
+class CGSolver {
+public:
+    // Takes over A (pass an rvalue to avoid the copy)
+    explicit CGSolver(SparseMatrix A, const CGSolverOptions& options = CGSolverOptions());
+
+    // Not copyable or movable: the preconditioner may reference the owned matrix
+    CGSolver(const CGSolver&) = delete;
+    CGSolver& operator=(const CGSolver&) = delete;
+
+    const SparseMatrix& matrix() const { return m_A; }
+    size_t rows() const { return m_A.rows(); }
+
+    // --- Value-only updates (the pattern never changes) ---
+
+    // Index of entry (row, col) for setValue / addValue; throws std::out_of_range
+    // if the entry is not part of the pattern. Look slots up once and keep them.
+    size_t slot(size_t row, size_t col) const { return m_A.findSlot(row, col); }
+
+    void setValue(size_t slot, double value);
+    void addValue(size_t slot, double value);
+
+    // Sets every stored value to zero (before re-accumulating with addValue)
+    void zeroValues();
+
+    // Copies all values of A, which must have exactly the solver's pattern
+    // (throws std::invalid_argument otherwise)
+    void setValues(const SparseMatrix& A);
+
+    // Direct access to the values in slot order; marks them as changed
+    double* values();
+
+    // Refactors the preconditioner for the current values now instead of at the next solve
+    void refresh();
+
+    // --- Solves ---
+
+    // x holds the initial guess on entry and the solution on exit
+    SolveReport solve(const Vector& b, Vector& x, SolveMonitor* monitor = nullptr);
+
+    // Warm start: starts from the previous solution (zero before the first
+    // solve) and returns the new one, which is kept for the next call
+    const Vector& solve(const Vector& b);
+
+    // Solution and report of the last solve(b)
+    const Vector& solution() const { return m_x; }
+    const SolveReport& lastReport() const { return m_report; }
+
+    // Zeroes the kept solution (e.g. after a discontinuous change of the problem)
+    void resetSolution();
+
+    // max_iter and tolerance may change between solves; the preconditioner is fixed at construction
+    CGSolverOptions& options() { return m_options; }
+    const CGSolverOptions& options() const { return m_options; }
+
+private:
+    SparseMatrix m_A;
+    CGSolverOptions m_options;
+    std::unique_ptr<Preconditioner> m_M;
+    bool m_values_changed;
+
+    CGWorkspace m_workspace;
+    Vector m_x;
+    SolveReport m_report;
+};
@@ -0,0 +1,115 @@
+// in file: include/Chebyshev.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "LinearOperator.hpp"
+#include "Preconditioner.hpp"
+#include "SparseMatrix.hpp"
+#include "vector.hpp"
+#include "cfd.hpp"
+
+// --- Spectral bounds ---
+
+// Estimated extreme eigenvalues of an SPD operator (of M^-1 A when a
+// preconditioner was involved)
+struct SpectrumEstimate {
+    double lambda_min = 0.0;
+    double lambda_max = 0.0;
+    size_t steps = 0; // Lanczos / power steps the estimate is based on
+};
+
+/**
+ * @brief Extreme eigenvalues of the symmetric tridiagonal matrix with the
+ * given diagonal and off-diagonal (off_diag.size() == diag.size() - 1).
+ * Bisection on Sturm sequence counts; accurate to rounding.
+ */
+SpectrumEstimate tridiagonal_extreme_eigenvalues(const std::vector<double>& diag,
+                                                 const std::vector<double>& off_diag);
+
+/**
+ * @brief Ritz values from the coefficients a CG / PCG solve recorded.
+ *
+ * CG is the Lanczos process in disguise: after k iterations its alpha and
+ * beta give the k x k Lanczos tridiagonal T_k of A (of M^-1 A for PCG),
+ *   T_00 = 1/alpha_0,  T_jj = 1/alpha_j + beta_{j-1}/alpha_{j-1},
+ *   T_j,j+1 = sqrt(beta_j)/alpha_j,
+ * whose extreme eigenvalues converge quickly to those of A from inside the
+ * spectrum. So the first solve yields the bounds for free.
+ * Throws std::invalid_argument if the report has no coefficients (only the
+ * SolveReport overloads of the classic solve_cg / solve_pcg record them).
+ */
+SpectrumEstimate spectrum_from_cg(const SolveReport& report);
+
+/**
+ * @brief Standalone Lanczos estimate: 'steps' CG iterations (PCG with M if
+ * given) on A x = b for a fixed pseudo-random b, then spectrum_from_cg.
+ */
+SpectrumEstimate estimate_spectrum(const LinearOperator& A, size_t steps = 20,
+                                   const Preconditioner* M = nullptr);
+
+/**
+ * @brief Power iteration for the largest eigenvalue of A (of M^-1 A if M is
+ * given). Cheaper per step than Lanczos but converges more slowly.
+ */
+double estimate_lambda_max(const LinearOperator& A, size_t iterations = 20,
+                           const Preconditioner* M = nullptr);
+
+// --- Chebyshev polynomial preconditioner ---
+
+/**
+ * @class ChebyshevPreconditioner
+ * @brief z = p(A) r with p a polynomial of the given degree: the result of
+ * degree + 1 steps of the Chebyshev iteration for A z = r on
+ * [lambda_min, lambda_max], started from z = 0 (degree 0 is r / centre).
+ *
+ * Unlike the triangular solves of SSOR and IC(0), applying it needs only
+ * 'degree' products with A and vector updates: no dot products, no
+ * sequential sweeps, so it parallelizes exactly like SpMV.
+ *
+ * An optional inner preconditioner (typically Jacobi) gives the polynomial
+ * in M^-1 A instead; the bounds must then be those of M^-1 A (for example
+ * spectrum_from_cg of a solve_pcg with the same M).
+ *
+ * The bounds must enclose the spectrum at the top: above lambda_max the
+ * polynomial can turn negative and CG breaks down. Lanczos / CG estimates
+ * approach lambda_max from below, so the constructor widens lambda_max by
+ * 'safety' (default 10%). A too large lambda_min only costs convergence,
+ * which is how the smoother variant works: lambda_min = lambda_max / 30
+ * damps the upper part of the spectrum only (as in AMG smoothing).
+ *
+ * The operator is referenced, not copied. apply() uses work vectors held by
+ * the preconditioner, so one instance must not be applied concurrently.
+ */
+class ChebyshevPreconditioner : public Preconditioner {
+public:
+    // Throws std::invalid_argument unless 0 < lambda_min < safety * lambda_max and safety >= 1
+    ChebyshevPreconditioner(const LinearOperator& A, const SpectrumEstimate& bounds, size_t degree = 3,
+                            const Preconditioner* inner = nullptr, double safety = 1.1);
+
+    void apply(const Vector& r, Vector& z) const;
+
+    // A's values changed in place (same object): the bounds are kept, as they
+    // usually change little; call setBounds() to refresh them. An inner
+    // preconditioner has to be updated by its owner.
+    void updateValues(const SparseMatrix& A);
+
+    // New spectral bounds (widened by the safety factor like in the constructor)
+    void setBounds(const SpectrumEstimate& bounds);
+
+    size_t degree() const { return m_degree; }
+    double lambdaMin() const { return m_lambda_min; }
+    double lambdaMax() const { return m_lambda_max; }
+
+private:
+    const LinearOperator& m_A;
+    const Preconditioner* m_inner;
+    size_t m_degree;
+    double m_safety;
+    double m_lambda_min;
+    double m_lambda_max;
+
+    mutable Vector m_residual;  // r - A z
+    mutable Vector m_direction; // update of z
+    mutable Vector m_work;      // A d, or M^-1 (r - A z)
+};
@@ -0,0 +1,19 @@
+// in file: include/CpuFeatures.hpp
+#pragma once
+
+// Runtime CPU feature detection for the SIMD kernels.
+// The kernels are compiled with per-function target attributes, so the
+// library itself still builds with the plain -std=c++11 flags and only
+// takes the AVX paths on machines that actually support them.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CFD_X86_DISPATCH 1
+#else
+#define CFD_X86_DISPATCH 0
+#endif
+
+// True if the CPU supports AVX2 (256-bit gathers)
+bool cpu_has_avx2();
+
+// True if the CPU supports AVX-512F (512-bit gathers)
+bool cpu_has_avx512f();
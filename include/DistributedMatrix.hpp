@@ -0,0 +1,176 @@
+// in file: include/DistributedMatrix.hpp
+#pragma once
+
+#include <mpi.h>
+#include <cstddef>
+#include <vector>
+#include "Memory.hpp"
+#include "vector.hpp"
+#include "SparseMatrix.hpp"
+#include "cfd.hpp"
+
+/**
+ * Distributed-memory (MPI) matrices, vectors and CG.
+ *
+ * NOT part of libLinearAlgebra.a: it needs an MPI compiler wrapper and is
+ * built by 'make mpi_cg' (see mpi_cg.cpp; run with 'mpirun -np 4 ./mpi_cg').
+ *
+ * Rows are distributed in contiguous blocks, in rank order: rank p owns the
+ * global rows [rowBegin(), rowEnd()) and the matching entries of every
+ * vector. A row that references columns owned by other ranks needs their
+ * x values ("ghosts" or "halo") before it can be multiplied.
+ */
+
+/**
+ * @class DistributedVector
+ * @brief The locally owned entries of a row-distributed vector.
+ *
+ * BLAS-1 updates work on local() directly (they need no communication);
+ * dot products and norms go through the free functions below.
+ */
+class DistributedVector {
+public:
+    DistributedVector();
+
+    // global_offsets has one entry per rank plus the total size; this rank's
+    // slice is allocated and set to zero
+    DistributedVector(MPI_Comm comm, const std::vector<size_t>& global_offsets);
+
+    MPI_Comm comm() const { return m_comm; }
+    size_t globalSize() const { return m_offsets.empty() ? 0 : m_offsets.back(); }
+    size_t rowBegin() const { return m_begin; }
+    size_t rowEnd() const { return m_begin + m_local.size(); }
+    size_t localSize() const { return m_local.size(); }
+    const std::vector<size_t>& offsets() const { return m_offsets; }
+
+    Vector& local() { return m_local; }
+    const Vector& local() const { return m_local; }
+
+    // Takes this rank's slice of a vector every rank holds in full
+    void scatter(const Vector& global);
+
+    // Collective: the full vector, on every rank
+    Vector gather() const;
+
+private:
+    MPI_Comm m_comm;
+    std::vector<size_t> m_offsets; // rank p owns [m_offsets[p], m_offsets[p + 1])
+    size_t m_begin;
+    Vector m_local;
+};
+
+/**
+ * How dot products are combined across ranks.
+ *  - Allreduce: one MPI_Allreduce of the per-rank sums (log P latency).
+ *  - Ordered: the running sum is passed from rank to rank and then
+ *    broadcast, so every sum is accumulated in the same order as the serial
+ *    dot_product. P - 1 latencies per dot, but the distributed CG then
+ *    produces bit-for-bit the iterates of the serial solve_cg.
+ */
+enum class DistributedReduction {
+    Allreduce,
+    Ordered
+};
+
+// Collective: global a . b
+double dot_product(const DistributedVector& a, const DistributedVector& b,
+                   DistributedReduction mode = DistributedReduction::Allreduce);
+
+// Collective: global ||a||
+double norm(const DistributedVector& a, DistributedReduction mode = DistributedReduction::Allreduce);
+
+/**
+ * @class DistributedMatrix
+ * @brief Row-distributed CSR matrix with a nonblocking halo exchange.
+ *
+ * Each rank stores its rows with local column numbers: owned columns come
+ * first (0 .. localRows()-1), ghost columns after them, grouped by owning
+ * rank. The rows are split into
+ *   - interior rows: every column is owned, so they need no remote data;
+ *   - boundary rows: at least one ghost column.
+ * multiply() posts the ghost receives and sends (MPI_Irecv / MPI_Isend),
+ * multiplies the interior rows while the messages are in flight, waits, and
+ * then multiplies the boundary rows. The entries of each row keep their
+ * original order, so every y_i is summed exactly as SparseMatrix::multiply
+ * sums it.
+ *
+ * The communication pattern (who sends which entries to whom) is worked out
+ * once, collectively, in the constructor.
+ */
+class DistributedMatrix {
+public:
+    // Collective. local_rows holds this rank's consecutive rows with GLOBAL
+    // column indices (local_rows.cols() is the global size); ranks own the
+    // row blocks in rank order.
+    DistributedMatrix(MPI_Comm comm, const SparseMatrix& local_rows);
+
+    // Collective. Every rank passes the same global matrix and keeps an
+    // nnz-balanced block of its rows (for tests and small drivers).
+    static DistributedMatrix distribute(MPI_Comm comm, const SparseMatrix& global);
+
+    DistributedMatrix(const DistributedMatrix&) = delete;
+    DistributedMatrix& operator=(const DistributedMatrix&) = delete;
+    DistributedMatrix(DistributedMatrix&&) = default;
+
+    MPI_Comm comm() const { return m_comm; }
+    size_t globalRows() const { return m_offsets.back(); }
+    size_t rowBegin() const { return m_begin; }
+    size_t rowEnd() const { return m_begin + m_num_local; }
+    size_t localRows() const { return m_num_local; }
+    size_t ghostCount() const { return m_ghost_global.size(); }
+    size_t interiorRows() const { return m_interior.rows.size(); }
+    size_t boundaryRows() const { return m_boundary.rows.size(); }
+    const std::vector<size_t>& offsets() const { return m_offsets; }
+
+    // A vector with this matrix's row distribution (all zeros)
+    DistributedVector createVector() const;
+
+    // Collective: y = A x, with the halo exchange overlapped with the interior rows.
+    // Not thread-safe: the ghost and send buffers are members.
+    void multiply(const DistributedVector& x, DistributedVector& y) const;
+
+private:
+    // One block of rows (interior or boundary) in CSR form
+    struct RowBlock {
+        IndexArray rows;    // local row numbers
+        IndexArray offsets; // rows.size() + 1 entries into cols / values
+        IndexArray cols;    // local column numbers (>= m_num_local: ghost)
+        DoubleArray values;
+    };
+
+    void checkVector(const DistributedVector& v, const char* what) const;
+
+    MPI_Comm m_comm;
+    std::vector<size_t> m_offsets;
+    size_t m_begin;
+    size_t m_num_local;
+
+    RowBlock m_interior;
+    RowBlock m_boundary;
+
+    std::vector<size_t> m_ghost_global;  // global index of each ghost column
+    std::vector<int> m_recv_ranks;       // neighbours we receive ghosts from
+    std::vector<size_t> m_recv_offsets;  // their ghosts: [m_recv_offsets[k], m_recv_offsets[k + 1])
+    std::vector<int> m_send_ranks;       // neighbours that need some of our entries
+    std::vector<size_t> m_send_offsets;  // into m_send_indices, per neighbour
+    std::vector<size_t> m_send_indices;  // local entries to send, grouped by neighbour
+
+    mutable DoubleArray m_ghosts;        // received x values of the ghost columns
+    mutable DoubleArray m_send_buffer;
+    mutable std::vector<MPI_Request> m_requests;
+};
+
+struct DistributedCGOptions {
+    DistributedReduction reduction = DistributedReduction::Allreduce;
+};
+
+/**
+ * @brief Collective CG on a distributed SPD system, same steps as solve_cg.
+ *
+ * Every rank returns the same report (the residuals are global). With
+ * DistributedReduction::Ordered the iterates match the serial solve_cg bit
+ * for bit; with Allreduce they agree up to the rounding of the dot products.
+ */
+SolveReport solve_cg(const DistributedMatrix& A, const DistributedVector& b, DistributedVector& x,
+                     size_t max_iter, double tolerance,
+                     const DistributedCGOptions& options = DistributedCGOptions());
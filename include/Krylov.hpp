@@ -0,0 +1,76 @@
+// in file: include/Krylov.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "LinearOperator.hpp"
+#include "Preconditioner.hpp"
+#include "Memory.hpp"
+#include "vector.hpp"
+#include "cfd.hpp"
+
+/**
+ * Krylov solvers for nonsymmetric systems (convection-diffusion, momentum).
+ *
+ * CG needs A to be symmetric positive definite. For a general nonsingular A:
+ *   - BiCGStab (van der Vorst, 1992): short recurrences, fixed memory (8
+ *     vectors), two SpMVs per iteration. Convergence can be irregular.
+ *   - GMRES(m) (Saad & Schultz, 1986): minimizes ||b - A x|| over a Krylov
+ *     space of up to m vectors, then restarts from the new x. Smooth,
+ *     monotone convergence, but it stores m + 1 basis vectors and each
+ *     iteration orthogonalizes against all of them.
+ *
+ * Both take an optional preconditioner, applied from the right
+ * (A M^-1 u = b, x = M^-1 u), so the residual they monitor is the true
+ * residual b - A x and the tolerance means the same as for solve_cg:
+ * ||r|| <= tolerance * ||b||.
+ */
+
+struct GmresOptions {
+    size_t restart = 30;        // m: basis vectors per cycle
+    size_t max_basis_bytes = 0; // cap on the basis memory; m is lowered to fit (0 = no cap)
+};
+
+// Reusable scratch space for solve_bicgstab / solve_gmres.
+// Keep one alive across solves and nothing is allocated after the first call.
+struct KrylovWorkspace {
+    // BiCGStab vectors (GMRES uses r, w and z)
+    Vector r, r_hat, p, v, s, t, p_hat, s_hat;
+    Vector w, z;
+
+    // GMRES basis V = [v_0 ... v_m], column-major in one aligned block (n x (m + 1))
+    DoubleArray basis;
+
+    // GMRES least-squares problem: Hessenberg columns, Givens rotations, rhs, coefficients
+    std::vector<double> hessenberg;
+    std::vector<double> cosines, sines, g, h, y;
+    std::vector<double> partial; // per-thread sums of the multi-dot kernel
+};
+
+// Basis vectors per GMRES cycle for n unknowns under the given options
+// (throws std::length_error if max_basis_bytes cannot hold two vectors)
+size_t gmres_restart_length(size_t n, const GmresOptions& options);
+
+// --- BiCGStab ---
+Vector solve_bicgstab(const LinearOperator& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance);
+SolveReport solve_bicgstab(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                           KrylovWorkspace& workspace, SolveMonitor* monitor = nullptr);
+SolveReport solve_bicgstab(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M,
+                           size_t max_iter, double tolerance, KrylovWorkspace& workspace,
+                           SolveMonitor* monitor = nullptr);
+
+// --- Restarted GMRES(m) ---
+// Arnoldi with classical Gram-Schmidt applied twice (CGS2): each pass
+// computes all projections h = V^T w with ONE multi-dot sweep over the
+// contiguous basis and subtracts them with one multi-axpy sweep, instead of
+// the j dependent dot products of modified Gram-Schmidt. The second pass
+// restores the orthogonality that a single classical pass loses.
+// max_iter counts inner iterations (SpMVs) over all cycles. A monitor sees
+// the Arnoldi residual estimate, with x and r as of the start of the cycle.
+Vector solve_gmres(const LinearOperator& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance,
+                   size_t restart = 30);
+SolveReport solve_gmres(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                        const GmresOptions& options, KrylovWorkspace& workspace, SolveMonitor* monitor = nullptr);
+SolveReport solve_gmres(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M,
+                        size_t max_iter, double tolerance, const GmresOptions& options,
+                        KrylovWorkspace& workspace, SolveMonitor* monitor = nullptr);
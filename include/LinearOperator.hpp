@@ -0,0 +1,38 @@
+// in file: include/LinearOperator.hpp
+#pragma once
+
+#include <cstddef>
+#include "vector.hpp"
+
+class MultiVector;
+
+/**
+ * @class LinearOperator
+ * @brief Anything that can compute y = A * x.
+ *
+ * The Krylov solvers (solve_cg, solve_pcg) only ever need the product A * x,
+ * so they accept any LinearOperator: stored matrices (SparseMatrix,
+ * SellMatrix, MappedSparseMatrix) as well as matrix-free operators such as
+ * the structured-grid stencils in Stencil.hpp that never store A at all.
+ */
+class LinearOperator {
+public:
+    virtual ~LinearOperator() {}
+
+    virtual size_t rows() const = 0;
+    virtual size_t cols() const = 0;
+
+    /**
+     * @brief Computes y = A * x.
+     * @param x Input vector with cols() elements.
+     * @param y Output vector, must already have rows() elements.
+     */
+    virtual void multiply(const Vector& x, Vector& y) const = 0;
+
+    /**
+     * @brief Computes Y = A * X for a block of vectors (see MultiVector.hpp).
+     * The default applies multiply() to one column at a time; SparseMatrix
+     * overrides it with an SpMM that reads each non-zero once for all columns.
+     */
+    virtual void multiplyBlock(const MultiVector& X, MultiVector& Y) const;
+};
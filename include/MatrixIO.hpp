@@ -0,0 +1,118 @@
+// in file: include/MatrixIO.hpp
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+#include "SparseMatrix.hpp"
+#include "vector.hpp"
+#include "LinearOperator.hpp"
+
+// --- Matrix Market (.mtx) text format ---
+// See https://math.nist.gov/MatrixMarket/formats.html. Supported:
+//   matrix coordinate real|integer|pattern  general|symmetric|skew-symmetric
+//   matrix array real|integer general (vectors only)
+// Symmetric files store one triangle; the reader mirrors it into full CSR.
+// All functions throw std::runtime_error on I/O or format errors.
+
+/**
+ * @brief Reads a sparse matrix from a Matrix Market coordinate file.
+ *
+ * The file is streamed in large blocks; each block is split at line
+ * boundaries and parsed by all threads of the global ThreadPool into a
+ * SparseMatrixBuilder, so entries may appear in any order.
+ */
+SparseMatrix read_matrix_market(const std::string& path);
+
+/**
+ * @brief Writes a matrix as "matrix coordinate real general" (1-based indices).
+ * Rows are formatted in parallel, block by block, and written in order.
+ */
+void write_matrix_market(const std::string& path, const SparseMatrix& A);
+
+/**
+ * @brief Reads a vector from a Matrix Market file (array format, or a
+ * coordinate file with a single column).
+ */
+Vector read_matrix_market_vector(const std::string& path);
+
+/**
+ * @brief Writes a vector as "matrix array real general" with one column.
+ */
+void write_matrix_market_vector(const std::string& path, const Vector& v);
+
+
+// --- Native binary CSR format ---
+// Layout (all integers are 64-bit, native byte order):
+//   [header, 64 bytes][row_offsets][col_indices][values]
+// Every section starts at a multiple of 64 bytes, so a memory-mapped file can
+// be used in place by the SpMV kernel with no parsing and no copy.
+
+struct BinaryCsrHeader {
+    char magic[8];              // "CFDCSR01"
+    uint64_t byte_order;        // 0x0102030405060708 as written by this machine
+    uint64_t num_rows;
+    uint64_t num_cols;
+    uint64_t nnz;
+    uint64_t row_offsets_offset; // byte offsets of the three sections
+    uint64_t col_indices_offset;
+    uint64_t values_offset;
+};
+
+/**
+ * @brief Writes A to a binary CSR file.
+ */
+void write_binary_csr(const std::string& path, const SparseMatrix& A);
+
+/**
+ * @brief Loads a binary CSR file into an ordinary (owning) SparseMatrix.
+ */
+SparseMatrix read_binary_csr(const std::string& path);
+
+/**
+ * @class MappedSparseMatrix
+ * @brief A read-only CSR matrix that lives in a memory-mapped binary CSR file.
+ *
+ * Opening maps the file and validates it in place: one read-only pass
+ * checks that the row offsets are monotone and end at nnz and that every
+ * column index is below cols() (std::runtime_error otherwise), so a corrupt
+ * file cannot make the SpMV read out of bounds. The values are not read or
+ * copied until the SpMV touches them, and the operating system's page cache
+ * keeps the file across runs. multiply() uses the same (threaded) kernel as
+ * SparseMatrix.
+ */
+class MappedSparseMatrix : public LinearOperator {
+public:
+    explicit MappedSparseMatrix(const std::string& path);
+    ~MappedSparseMatrix();
+
+    // Owns a mapping, so copying is not allowed
+    MappedSparseMatrix(const MappedSparseMatrix&) = delete;
+    MappedSparseMatrix& operator=(const MappedSparseMatrix&) = delete;
+
+    size_t rows() const { return m_num_rows; }
+    size_t cols() const { return m_num_cols; }
+    size_t nnz() const { return m_nnz; }
+
+    // Direct views of the mapped CSR arrays
+    const size_t* rowOffsets() const { return m_row_offsets; }
+    const size_t* colIndices() const { return m_col_indices; }
+    const double* values() const { return m_values; }
+
+    // Core Operation: y = A * x
+    Vector operator*(const Vector& x) const;
+    void multiply(const Vector& x, Vector& y) const;
+
+    // Makes an owning copy (e.g. to build a preconditioner from it)
+    SparseMatrix toSparseMatrix() const;
+
+private:
+    void* m_mapping;
+    size_t m_mapping_size;
+    size_t m_num_rows;
+    size_t m_num_cols;
+    size_t m_nnz;
+    const size_t* m_row_offsets;
+    const size_t* m_col_indices;
+    const double* m_values;
+};
@@ -0,0 +1,187 @@
+// in file: include/Memory.hpp
+#pragma once
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Memory for the large numeric arrays (Vector storage, the CSR arrays of
+ * SparseMatrix).
+ *
+ *  - Alignment: every block starts on a 64-byte boundary (one cache line,
+ *    one AVX-512 register), so SIMD loads never split a cache line.
+ *  - Huge pages: blocks of 2 MiB and more are 2 MiB aligned and advised to
+ *    use transparent huge pages where the OS supports it (Linux madvise),
+ *    which cuts TLB misses when a kernel streams through the array.
+ *  - Pooling: freed blocks are kept in per-size free lists and handed out
+ *    again, so the temporaries of a solver loop stop going through malloc
+ *    and the kernel's page-zeroing after the first iteration.
+ *  - First touch: on a NUMA machine a page lands on the node of the thread
+ *    that writes it first. AlignedAllocator does NOT zero what it allocates;
+ *    the owners (Vector, SparseMatrix) initialize their arrays in parallel
+ *    with parallel_fill / parallel_copy, so each page is first touched by
+ *    the thread that later works on it.
+ *
+ * The memory used by new arrays comes from default_memory_resource(), which
+ * is the global pool unless replaced with set_default_memory_resource().
+ * An array remembers the resource it came from and always returns its
+ * memory there.
+ */
+
+// Alignment of every block handed out by a MemoryResource
+const size_t kMemoryAlignment = 64;
+
+/**
+ * @class MemoryResource
+ * @brief Source of raw, kMemoryAlignment-aligned memory blocks.
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() {}
+
+    // Returns a block of at least 'bytes' bytes (throws std::bad_alloc)
+    virtual void* allocate(size_t bytes) = 0;
+
+    // Returns a block obtained from allocate(bytes) with the same 'bytes'
+    virtual void deallocate(void* p, size_t bytes) = 0;
+};
+
+/**
+ * @class AlignedResource
+ * @brief Aligned blocks straight from the system allocator, with
+ * huge-page advice for blocks of 2 MiB and more.
+ */
+class AlignedResource : public MemoryResource {
+public:
+    void* allocate(size_t bytes);
+    void deallocate(void* p, size_t bytes);
+
+    // The process-wide instance
+    static AlignedResource& instance();
+};
+
+/**
+ * @class PoolResource
+ * @brief Recycles freed blocks by size.
+ *
+ * Requests are rounded up to a multiple of 64 bytes and each rounded size
+ * has its own free list. A solver allocates the same few sizes over and
+ * over (vectors of n unknowns), so after the first iteration every request
+ * is a free-list hit. At most max_cached_bytes are kept; blocks freed
+ * beyond that go back to the upstream resource. Thread-safe.
+ */
+class PoolResource : public MemoryResource {
+public:
+    struct Stats {
+        size_t allocations = 0;  // calls to allocate()
+        size_t reuses = 0;       // served from a free list
+        size_t cached_bytes = 0; // bytes currently held in free lists
+    };
+
+    explicit PoolResource(MemoryResource& upstream = AlignedResource::instance(),
+                          size_t max_cached_bytes = size_t(512) << 20);
+    ~PoolResource();
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    void* allocate(size_t bytes);
+    void deallocate(void* p, size_t bytes);
+
+    // Returns every cached block to the upstream resource
+    void release();
+
+    Stats stats() const;
+
+private:
+    MemoryResource& m_upstream;
+    size_t m_max_cached_bytes;
+    std::map<size_t, std::vector<void*> > m_free; // rounded size -> free blocks
+    Stats m_stats;
+    mutable std::mutex m_mutex;
+};
+
+// The pool behind default_memory_resource() (lives until the program exits)
+PoolResource& global_memory_pool();
+
+// Resource used by arrays created from now on
+MemoryResource& default_memory_resource();
+
+// Replaces the default resource; nullptr restores the global pool.
+// The resource must outlive every array allocated from it.
+void set_default_memory_resource(MemoryResource* resource);
+
+/**
+ * @class AlignedAllocator
+ * @brief std::allocator replacement that draws from a MemoryResource.
+ *
+ * Default-constructed elements are left uninitialized (construct() with no
+ * arguments default-initializes), so std::vector<double, AlignedAllocator>(n)
+ * does not write the pages; the owner fills them, in parallel. Construction
+ * with a value (resize(n, 0.0), push_back, copies) works as usual.
+ */
+template <class T>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+    // The resource travels with the memory it owns
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <class U>
+    struct rebind { typedef AlignedAllocator<U> other; };
+
+    AlignedAllocator() : m_resource(&default_memory_resource()) {}
+    explicit AlignedAllocator(MemoryResource* resource) : m_resource(resource) {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U>& other) : m_resource(other.resource()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(m_resource->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        m_resource->deallocate(p, n * sizeof(T));
+    }
+
+    template <class U>
+    void construct(U* p) {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <class U, class... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    MemoryResource* resource() const { return m_resource; }
+
+private:
+    MemoryResource* m_resource;
+};
+
+template <class T, class U>
+bool operator==(const AlignedAllocator<T>& a, const AlignedAllocator<U>& b) {
+    return a.resource() == b.resource();
+}
+
+template <class T, class U>
+bool operator!=(const AlignedAllocator<T>& a, const AlignedAllocator<U>& b) {
+    return a.resource() != b.resource();
+}
+
+// Array types of Vector and SparseMatrix
+typedef std::vector<double, AlignedAllocator<double> > DoubleArray;
+typedef std::vector<size_t, AlignedAllocator<size_t> > IndexArray;
+
+// --- Parallel first-touch initialization ---
+// Thread t of the global ThreadPool writes elements [n*t/T, n*(t+1)/T), the
+// contiguous split used by the vector kernels (and by the SpMV row partition
+// when the rows hold similar numbers of non-zeros). Short arrays are written
+// serially.
+void parallel_fill(double* data, size_t n, double value);
+void parallel_copy(const double* src, double* dst, size_t n);
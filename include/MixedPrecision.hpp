@@ -0,0 +1,71 @@
+// in file: include/MixedPrecision.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "CompactCsrMatrix.hpp"
+#include "SparseMatrix.hpp"
+#include "vector.hpp"
+#include "cfd.hpp"
+
+/**
+ * @class MixedPrecisionCG
+ * @brief CG with a single-precision inner solver and double-precision
+ * iterative refinement.
+ *
+ * Each outer step computes the true residual r = b - A x with the double
+ * matrix, solves A d = r approximately with CG on a float copy of A
+ * (CompactCsrMatrix<float, uint32_t>, 8 bytes per non-zero instead of 16)
+ * and float vectors, then updates x += d in double. The inner solves do
+ * almost all the work at half the memory traffic; the outer loop removes
+ * their rounding error, so the final ||b - A x|| < tolerance * ||b|| is
+ * checked in double exactly as in solve_cg.
+ *
+ * The residual is scaled to unit norm before it is rounded to float, so the
+ * inner solve does not underflow as the outer residual gets small.
+ */
+class MixedPrecisionCG {
+public:
+    /**
+     * @brief Builds the float copy of A. A must stay alive while the solver is used.
+     */
+    explicit MixedPrecisionCG(const SparseMatrix& A);
+
+    /**
+     * @brief Relative tolerance of each inner float solve (default 1e-4).
+     * Float rounding limits what the inner CG can reach, so values much below
+     * 1e-6 only cost iterations.
+     */
+    void setInnerTolerance(double tolerance);
+    double innerTolerance() const { return m_inner_tolerance; }
+
+    /**
+     * @brief Solves A x = b; x holds the initial guess on entry.
+     * @param max_iter Limit on the total number of inner CG iterations.
+     * @param monitor Optional; called after every outer (refinement) step.
+     * @return Report in which iterations counts inner CG iterations and
+     *         residual_history holds the double residual after each outer step.
+     */
+    SolveReport solve(const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                      SolveMonitor* monitor = nullptr) const;
+
+    const CompactCsrMatrix<float, uint32_t>& floatMatrix() const { return m_A_float; }
+
+private:
+    // Float CG on m_A_float from d = 0; returns the iterations used
+    size_t innerSolve(size_t max_iter, SolveReport& report) const;
+
+    const SparseMatrix& m_A;
+    CompactCsrMatrix<float, uint32_t> m_A_float;
+    double m_inner_tolerance;
+
+    // Scratch space, reused across solves
+    mutable Vector m_r;
+    mutable std::vector<float> m_rf, m_d, m_p, m_Ap;
+};
+
+/**
+ * @brief One-shot mixed-precision solve with the same interface as solve_cg.
+ */
+Vector solve_cg_mixed(const SparseMatrix& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance);
@@ -0,0 +1,52 @@
+// in file: include/MultiVector.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "vector.hpp"
+
+/**
+ * @class MultiVector
+ * @brief A block of k vectors of the same length, stored row-major.
+ *
+ * Entry (i, j) (row i of column j) is at data()[i * cols() + j], so the k
+ * values of one row sit next to each other. That is the layout the sparse
+ * matrix x multi-vector product (SpMM) wants: for every non-zero A_ik it reads
+ * the k entries of row k of X in one cache line and updates all k sums, so
+ * the matrix is streamed from memory once for all columns.
+ */
+class MultiVector {
+public:
+    // Empty 0 x 0 block
+    MultiVector();
+
+    // rows x cols block initialized with zeros
+    MultiVector(size_t rows, size_t cols);
+
+    size_t rows() const { return m_rows; }
+    size_t cols() const { return m_cols; }
+
+    // Element access with bounds checking (throws std::out_of_range)
+    double& operator()(size_t row, size_t col);
+    const double& operator()(size_t row, size_t col) const;
+
+    // Raw row-major storage
+    double* data() { return m_data.data(); }
+    const double* data() const { return m_data.data(); }
+
+    // Pointer to the cols() entries of one row (no bounds check)
+    double* row(size_t i) { return m_data.data() + i * m_cols; }
+    const double* row(size_t i) const { return m_data.data() + i * m_cols; }
+
+    // Copies column j out of / into a Vector
+    Vector column(size_t j) const;
+    void setColumn(size_t j, const Vector& v);
+
+    // Changes the shape; contents are zeroed if the shape changes
+    void resize(size_t rows, size_t cols);
+
+private:
+    size_t m_rows;
+    size_t m_cols;
+    std::vector<double> m_data;
+};
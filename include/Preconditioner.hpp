@@ -0,0 +1,134 @@
+// in file: include/Preconditioner.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "SparseMatrix.hpp"
+#include "vector.hpp"
+
+/**
+ * @class Preconditioner
+ * @brief Interface for preconditioners used by solve_pcg.
+ *
+ * A preconditioner M approximates A but is cheap to invert. Each CG iteration
+ * calls apply() once to compute z = M^-1 r. For CG, M must be symmetric
+ * positive definite.
+ */
+class Preconditioner {
+public:
+    virtual ~Preconditioner() {}
+
+    /**
+     * @brief Computes z = M^-1 * r.
+     * @param r The residual (input).
+     * @param z The preconditioned residual (output, must already have r.size() elements).
+     */
+    virtual void apply(const Vector& r, Vector& z) const = 0;
+
+    /**
+     * @brief Recomputes the numeric part of M for new values of A.
+     * A must have the same sparsity pattern as the matrix M was built from;
+     * everything derived from the pattern alone is kept. The default throws
+     * std::runtime_error (the preconditioner has to be rebuilt instead).
+     */
+    virtual void updateValues(const SparseMatrix& A);
+};
+
+/**
+ * @class JacobiPreconditioner
+ * @brief M = diag(A). Cheapest option; fully parallel.
+ */
+class JacobiPreconditioner : public Preconditioner {
+public:
+    explicit JacobiPreconditioner(const SparseMatrix& A);
+    void apply(const Vector& r, Vector& z) const;
+    void updateValues(const SparseMatrix& A);
+
+private:
+    std::vector<double> m_inv_diag; // 1 / a_ii
+};
+
+/**
+ * @class SSORPreconditioner
+ * @brief Symmetric successive over-relaxation (omega = 1 gives symmetric Gauss-Seidel).
+ *
+ * M = omega/(2-omega) * (D/omega + L) (D/omega)^-1 (D/omega + U), applied with
+ * one forward and one backward sweep over A. The matrix is referenced, not
+ * copied, so A must outlive the preconditioner; updateValues() takes that
+ * same matrix after its values changed in place.
+ */
+class SSORPreconditioner : public Preconditioner {
+public:
+    SSORPreconditioner(const SparseMatrix& A, double omega = 1.0);
+    void apply(const Vector& r, Vector& z) const;
+    void updateValues(const SparseMatrix& A);
+
+private:
+    const SparseMatrix& m_A;
+    double m_omega;
+    std::vector<double> m_diag;
+};
+
+/**
+ * @class IC0Preconditioner
+ * @brief Incomplete Cholesky with zero fill-in: M = L * L^T, where L keeps the
+ * sparsity pattern of the lower triangle of A.
+ *
+ * The two triangular solves are level-scheduled: rows are grouped into levels
+ * whose rows only depend on earlier levels, and the rows of one level are
+ * solved in parallel on the global ThreadPool. The results do not depend on
+ * the number of threads.
+ *
+ * Setup is split into a symbolic phase (pattern of L and L^T, level
+ * schedules, where each value of A goes) and the numeric factorization, so
+ * updateValues() only refactors.
+ */
+class IC0Preconditioner : public Preconditioner {
+public:
+    // Throws std::runtime_error if a pivot is not positive (A not SPD enough for IC(0))
+    explicit IC0Preconditioner(const SparseMatrix& A);
+    void apply(const Vector& r, Vector& z) const;
+
+    // Numeric refactorization only; throws like the constructor, and
+    // std::invalid_argument if A's sparsity pattern differs from the one set up
+    void updateValues(const SparseMatrix& A);
+
+    // Number of levels in the forward (L) and backward (L^T) solves
+    size_t forwardLevels() const { return m_lower_levels.offsets.size() - 1; }
+    size_t backwardLevels() const { return m_upper_levels.offsets.size() - 1; }
+
+private:
+    // Rows grouped by level: level l holds rows[offsets[l] .. offsets[l+1])
+    struct LevelSchedule {
+        std::vector<size_t> offsets;
+        std::vector<size_t> rows;
+    };
+
+    // A triangular factor in CSR form; the diagonal is stored separately
+    struct Triangle {
+        std::vector<size_t> row_offsets;
+        std::vector<size_t> col_indices;
+        std::vector<double> values;
+        std::vector<double> diag;
+    };
+
+    void factorize(const DoubleArray& values);
+    static LevelSchedule buildLevels(const Triangle& T, bool lower);
+    static void solve(const Triangle& T, const LevelSchedule& levels, const double* rhs, double* out);
+
+    Triangle m_lower; // L, strictly lower part (columns sorted)
+    Triangle m_upper; // L^T, strictly upper part
+    LevelSchedule m_lower_levels;
+    LevelSchedule m_upper_levels;
+
+    // Symbolic data for factorize(): entry k of A is added to m_lower.values
+    // (index < nnz(L)), to diagonal m_source[k] - nnz(L), or dropped (kDropped);
+    // m_upper_source[k] is the entry of L that entry k of L^T copies
+    static const size_t kDropped = static_cast<size_t>(-1);
+    std::vector<size_t> m_source;
+    std::vector<size_t> m_upper_source;
+
+    // Sparsity pattern of the A the symbolic phase was built from
+    std::vector<size_t> m_pattern_offsets;
+    std::vector<size_t> m_pattern_cols;
+};
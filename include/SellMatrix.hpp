@@ -0,0 +1,82 @@
+// in file: include/SellMatrix.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "SparseMatrix.hpp"
+#include "vector.hpp"
+#include "LinearOperator.hpp"
+
+/**
+ * @class SellMatrix
+ * @brief A sparse matrix in SELL-C-sigma (sliced ELLPACK) format.
+ *
+ * Rows are grouped into chunks of C = kChunkHeight rows. Inside a chunk all
+ * rows are padded to the length of the longest one and stored column by
+ * column, so one "column" of a chunk is C values that sit next to each other
+ * in memory. The SpMV inner loop then processes C rows at once with SIMD
+ * gathers instead of walking one short CSR row at a time.
+ *
+ * To keep padding small, rows are sorted by length (longest first) inside
+ * windows of sigma rows before chunking. The resulting row permutation is
+ * kept inside the matrix: multiply() takes x and returns y in the ORIGINAL
+ * row order, so the class is a drop-in replacement for SparseMatrix in
+ * solve_cg and callers never see the reordering.
+ */
+class SellMatrix : public LinearOperator {
+public:
+    // Rows per chunk: 8 doubles fill one AVX-512 register (two AVX2 registers)
+    static const size_t kChunkHeight = 8;
+
+    // Which SpMV implementation multiply() uses
+    enum Kernel { Scalar, AVX2, AVX512 };
+
+    /**
+     * @brief Converts a CSR matrix to SELL-C-sigma.
+     * @param A The CSR matrix to convert.
+     * @param sigma Sorting window in rows (1 = no sorting).
+     * The fastest kernel supported by the CPU is selected automatically;
+     * with 2^31 columns or more (beyond the signed 32-bit gather indices)
+     * only the scalar kernel is used.
+     */
+    explicit SellMatrix(const SparseMatrix& A, size_t sigma = 256);
+
+    size_t rows() const { return m_num_rows; }
+    size_t cols() const { return m_num_cols; }
+
+    // Number of real non-zeros and number of stored entries (including padding)
+    size_t nnz() const { return m_nnz; }
+    size_t storedEntries() const { return m_values.size(); }
+
+    /**
+     * @brief Row permutation: position i of the SELL layout holds original row permutation()[i].
+     */
+    const std::vector<size_t>& permutation() const { return m_permutation; }
+
+    // Core Operation: y = A * x, both in the original row order
+    Vector operator*(const Vector& x) const;
+    void multiply(const Vector& x, Vector& y) const;
+
+    // Kernel selection (e.g. to compare the SIMD kernels against the scalar one).
+    // setKernel throws std::runtime_error for a SIMD kernel the CPU lacks or
+    // that cannot index this many columns.
+    Kernel kernel() const { return m_kernel; }
+    void setKernel(Kernel kernel);
+
+private:
+    size_t m_num_rows;
+    size_t m_num_cols;
+    size_t m_nnz;
+
+    // Chunk c starts at m_chunk_offsets[c] and holds m_chunk_widths[c] columns of C entries
+    std::vector<size_t> m_chunk_offsets;
+    std::vector<size_t> m_chunk_widths;
+
+    // Chunk-major, then column, then lane. Column indices are 32-bit for the gathers.
+    std::vector<double> m_values;
+    std::vector<uint32_t> m_col_indices;
+
+    std::vector<size_t> m_permutation;
+    Kernel m_kernel;
+};
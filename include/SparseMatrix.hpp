@@ -4,27 +4,122 @@
 #include <vector>
 #include <cstddef>
 #include "vector.hpp" // Dependency: The Matrix operates on the Vector class
+#include "Memory.hpp" // DoubleArray / IndexArray storage
+#include "LinearOperator.hpp"
+#include "MultiVector.hpp"
+#include "ThreadPool.hpp"
 
-class SparseMatrix {
+class SparseMatrix : public LinearOperator {
 public:
     // Constructor: Creates an NxM matrix, reserving space for non-zero elements
     SparseMatrix(size_t num_rows, size_t num_cols, size_t capacity);
 
+    // Constructor: Takes over ready-made CSR arrays in aligned storage.
+    // No copy is made. Used by SparseMatrixBuilder and the other producers,
+    // which fill the arrays with csr_row_blocks so that each thread's rows are
+    // first touched (and on a NUMA machine placed) by that thread.
+    SparseMatrix(size_t num_rows, size_t num_cols,
+                 DoubleArray&& values,
+                 IndexArray&& col_indices,
+                 IndexArray&& row_offsets);
+
+    // Constructor: Takes over plain std::vector CSR arrays. They are copied
+    // once into aligned storage with csr_place_copy and then released.
+    SparseMatrix(size_t num_rows, size_t num_cols,
+                 std::vector<double>&& values,
+                 std::vector<size_t>&& col_indices,
+                 std::vector<size_t>&& row_offsets);
+
     // Modifies the matrix structure (Simplified CSR construction)
     void setValue(size_t row, size_t col, double value);
 
     // Core Operation: Matrix multiplied by a Vector (result = A * x)
     Vector operator*(const Vector& x) const;
 
+    // In-place product y = A * x (y must already have num_rows elements).
+    // Runs on the global ThreadPool when more than one thread is configured;
+    // the result is bit-for-bit identical to the serial path.
+    void multiply(const Vector& x, Vector& y) const;
+
+    // Block product Y = A * X for k right-hand sides at once (SpMM). Each
+    // non-zero is read once for all k columns; threaded like multiply().
+    void multiplyBlock(const MultiVector& X, MultiVector& Y) const;
+    MultiVector operator*(const MultiVector& X) const;
+
+    // Transpose: returns A^T (column indices sorted within each row)
+    SparseMatrix transpose() const;
+
+    // Sparse matrix-matrix product C = A * B (Gustavson's row-by-row algorithm)
+    SparseMatrix operator*(const SparseMatrix& B) const;
+
+    // Position of entry (row, col) in values(), for value-only updates of a
+    // fixed sparsity pattern. Column indices must be sorted within the row (as
+    // SparseMatrixBuilder leaves them). Throws std::out_of_range if the entry
+    // is not part of the pattern.
+    size_t findSlot(size_t row, size_t col) const;
+
+    // Writable view of the non-zero values; the sparsity pattern stays fixed
+    double* mutableValues() { return m_values.data(); }
+
+    // Splits the rows into num_parts contiguous ranges with roughly equal
+    // numbers of non-zeros. Part p owns rows [bounds[p], bounds[p+1]).
+    std::vector<size_t> rowPartition(size_t num_parts) const;
+
+    // --- Read-only access to the dimensions and the raw CSR arrays ---
+    size_t rows() const { return m_num_rows; }
+    size_t cols() const { return m_num_cols; }
+    size_t nnz() const { return m_values.size(); }
+
+    const DoubleArray& values() const { return m_values; }
+    const IndexArray& colIndices() const { return m_col_indices; }
+    const IndexArray& rowOffsets() const { return m_row_offsets; }
+
 private:
     // --- CSR Format Data Storage ---
     size_t m_num_rows;
     size_t m_num_cols;
     
+    // (aligned, pooled arrays, see Memory.hpp)
     // 1. Stores all non-zero values
-    std::vector<double> m_values;      
+    DoubleArray m_values;
     // 2. Stores the column index for each value in m_values
-    std::vector<size_t> m_col_indices; 
+    IndexArray m_col_indices;
     // 3. Stores the starting index for each row in m_values (the "bookmarks")
-    std::vector<size_t> m_row_offsets; 
+    IndexArray m_row_offsets;
 };
+
+// --- CSR kernels on raw arrays ---
+// Shared by SparseMatrix and by formats that do not own std::vectors
+// (e.g. a memory-mapped matrix), so all of them use the same SpMV code.
+
+// y = A * x for a CSR matrix given by its arrays (threaded like SparseMatrix::multiply)
+void csr_multiply(size_t num_rows, size_t num_cols,
+                  const size_t* row_offsets, const size_t* col_indices, const double* values,
+                  const Vector& x, Vector& y);
+
+// nnz-balanced split of the rows into num_parts contiguous ranges
+std::vector<size_t> csr_row_partition(size_t num_rows, const size_t* row_offsets, size_t num_parts);
+
+// Calls fn(row_begin, row_end) for the nnz-balanced row block of each pool
+// thread, the blocks csr_multiply uses (one block [0, num_rows) for a matrix
+// too small to thread). Filling a new CSR matrix's arrays through it makes
+// every thread first touch the rows it will later multiply.
+template <class Fn>
+void csr_row_blocks(size_t num_rows, const size_t* row_offsets, Fn fn) {
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || row_offsets[num_rows] < kParallelMinWork) {
+        fn(size_t(0), num_rows);
+        return;
+    }
+    const std::vector<size_t> bounds = csr_row_partition(num_rows, row_offsets, pool.size());
+    pool.run([&](size_t tid, size_t num_threads) {
+        fn(bounds[tid * (bounds.size() - 1) / num_threads],
+           bounds[(tid + 1) * (bounds.size() - 1) / num_threads]);
+    });
+}
+
+// Copies CSR arrays into freshly allocated aligned arrays (resized here),
+// row block by row block with csr_row_blocks
+void csr_place_copy(size_t num_rows, const size_t* row_offsets, const size_t* col_indices,
+                    const double* values, DoubleArray& dst_values, IndexArray& dst_cols,
+                    IndexArray& dst_offsets);
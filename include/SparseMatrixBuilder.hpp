@@ -0,0 +1,78 @@
+// in file: include/SparseMatrixBuilder.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "SparseMatrix.hpp"
+#include "SymmetricSparseMatrix.hpp"
+
+/**
+ * @class SparseMatrixBuilder
+ * @brief Collects (row, col, value) triplets and turns them into a SparseMatrix.
+ *
+ * Unlike SparseMatrix::setValue, entries may be added in any order and the
+ * same (row, col) position may be added several times: duplicates are summed,
+ * which is exactly what finite-volume / finite-element assembly needs.
+ *
+ * The builder keeps one triplet buffer per thread slot, so several threads can
+ * fill it at the same time without locking as long as each thread uses its own
+ * slot index. build() then merges all slots with two counting sorts
+ * (by column, then stably by row), which costs O(nnz + rows + cols).
+ */
+class SparseMatrixBuilder {
+public:
+    /**
+     * @brief Creates a builder for an NxM matrix.
+     * @param num_rows Number of matrix rows.
+     * @param num_cols Number of matrix columns.
+     * @param num_slots Number of independent buffers (one per filling thread).
+     */
+    SparseMatrixBuilder(size_t num_rows, size_t num_cols, size_t num_slots = 1);
+
+    /**
+     * @brief Reserves room for a number of triplets in one slot.
+     */
+    void reserve(size_t capacity, size_t slot = 0);
+
+    /**
+     * @brief Adds value to position (row, col). Repeated positions are summed.
+     * @param slot The buffer to append to. Each thread must use its own slot.
+     */
+    void addValue(size_t row, size_t col, double value, size_t slot = 0);
+
+    /**
+     * @brief Number of triplets currently stored (duplicates counted separately).
+     */
+    size_t size() const;
+
+    /**
+     * @brief Produces the CSR matrix and empties the builder.
+     *
+     * Column indices come out sorted within each row and duplicates merged.
+     * The merge writes straight into aligned arrays, one row block per pool
+     * thread (csr_row_blocks), so each thread first touches the rows it will
+     * multiply; the arrays are then moved into the SparseMatrix, no copy.
+     */
+    SparseMatrix build();
+
+    /**
+     * @brief Produces the symmetric (upper-triangle) matrix and empties the builder.
+     *
+     * Triplets below the diagonal are dropped before sorting: a symmetric
+     * assembly adds every coupling as (i, j) and (j, i), and only the
+     * (i, j) with i <= j is kept.
+     */
+    SymmetricSparseMatrix buildSymmetric();
+
+private:
+    // One buffer of triplets, stored as three parallel arrays
+    struct Slot {
+        std::vector<size_t> rows;
+        std::vector<size_t> cols;
+        std::vector<double> values;
+    };
+
+    size_t m_num_rows;
+    size_t m_num_cols;
+    std::vector<Slot> m_slots;
+};
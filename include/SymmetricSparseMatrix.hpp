@@ -0,0 +1,69 @@
+// in file: include/SymmetricSparseMatrix.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "LinearOperator.hpp"
+#include "SparseMatrix.hpp"
+#include "vector.hpp"
+
+/**
+ * @class SymmetricSparseMatrix
+ * @brief A symmetric matrix stored as its diagonal and upper triangle (CSR).
+ *
+ * Every matrix solve_cg handles is symmetric, so half of a full CSR matrix
+ * is redundant. Storing only a_ij with j >= i roughly halves the memory and
+ * the bytes an SpMV has to stream. Each stored off-diagonal a_ij is used
+ * twice per product:
+ *     y_i += a_ij * x_j   (row i, as in plain CSR)
+ *     y_j += a_ij * x_i   (the mirrored entry of the lower triangle)
+ *
+ * The second update scatters into y, so rows cannot simply be split among
+ * threads. The threaded product gives each thread its nnz-balanced block of
+ * rows: updates inside the block go straight to y, updates of later rows go
+ * to a thread-local buffer that only spans the rows the block reaches
+ * (small after a bandwidth-reducing ordering, see Reordering.hpp). A second
+ * pass adds the buffers into y. Results are deterministic for a fixed
+ * thread count but round differently than multiplySerial().
+ *
+ * It is a LinearOperator, so solve_cg / solve_pcg accept it directly.
+ */
+class SymmetricSparseMatrix : public LinearOperator {
+public:
+    /**
+     * @brief Keeps the diagonal and upper triangle of a square matrix.
+     * A is assumed to be symmetric; its lower triangle is not read.
+     */
+    explicit SymmetricSparseMatrix(const SparseMatrix& A);
+
+    /**
+     * @brief Takes over a matrix that already holds only its upper triangle
+     * (throws std::invalid_argument if it has an entry below the diagonal).
+     */
+    static SymmetricSparseMatrix fromUpperTriangle(SparseMatrix&& upper);
+
+    size_t rows() const { return m_upper.rows(); }
+    size_t cols() const { return m_upper.cols(); }
+
+    // Stored non-zeros (diagonal + upper triangle)
+    size_t nnz() const { return m_upper.nnz(); }
+
+    // y = A * x; threaded on the global ThreadPool for large matrices
+    void multiply(const Vector& x, Vector& y) const;
+    Vector operator*(const Vector& x) const;
+
+    // y = A * x on the calling thread only
+    void multiplySerial(const Vector& x, Vector& y) const;
+
+    // The stored upper triangle as a CSR matrix
+    const SparseMatrix& upper() const { return m_upper; }
+
+    // Expands to the full matrix (both triangles), e.g. for the preconditioners
+    SparseMatrix toSparseMatrix() const;
+
+private:
+    struct UpperTriangle {};
+    SymmetricSparseMatrix(SparseMatrix&& upper, UpperTriangle);
+
+    SparseMatrix m_upper;
+};
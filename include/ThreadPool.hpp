@@ -0,0 +1,145 @@
+// in file: include/ThreadPool.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+/**
+ * @class ThreadPool
+ * @brief A persistent pool of worker threads for data-parallel kernels.
+ *
+ * The threads are created once and then sleep between calls, so a kernel
+ * such as SpMV can go parallel on every solver iteration without paying
+ * for thread creation each time.
+ *
+ * The pool works in "SPMD" style: run(fn) calls fn(thread_id, num_threads)
+ * exactly once on every thread (the calling thread acts as thread 0) and
+ * returns when all of them have finished. Each kernel then decides which
+ * part of the data belongs to which thread_id. Because that split is static,
+ * the same thread always touches the same rows, which keeps results
+ * deterministic and caches warm.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Creates a pool with num_threads threads in total (including the caller).
+     */
+    explicit ThreadPool(size_t num_threads = 1);
+
+    /**
+     * @brief Stops and joins all worker threads.
+     */
+    ~ThreadPool();
+
+    // A pool owns threads, so it can be neither copied nor moved
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Total number of threads taking part in run(), including the caller.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Changes the number of threads. Existing workers are joined first.
+     */
+    void resize(size_t num_threads);
+
+    /**
+     * @brief Runs fn(thread_id, num_threads) on every thread and waits for all of them.
+     *
+     * A call made from inside a running task (nested parallelism) is executed
+     * serially on the calling thread as fn(0, 1).
+     * If a task throws, the first exception is rethrown here after all threads finished.
+     */
+    void run(const std::function<void(size_t, size_t)>& fn);
+
+    /**
+     * @brief The process-wide pool used by the library kernels.
+     */
+    static ThreadPool& global();
+
+private:
+    void startWorkers(size_t num_threads);
+    void stopWorkers();
+    void workerLoop(size_t thread_id, size_t start_generation);
+
+    std::vector<std::thread> m_workers;
+    size_t m_num_threads;
+
+    std::mutex m_run_mutex;        // Only one run() may be in flight at a time
+    std::mutex m_mutex;            // Protects everything below
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t, size_t)>* m_task;
+    size_t m_generation;           // Incremented for every new task
+    size_t m_pending;              // Workers that have not finished the current task
+    bool m_stop;
+    std::exception_ptr m_error;
+};
+
+/**
+ * @class SerialKernelScope
+ * @brief While alive, ThreadPool::run() on the current thread runs the task
+ * serially as fn(0, 1), exactly like a nested call.
+ *
+ * For threads that already run one independent job per core (see
+ * BatchSolver.hpp): the kernels inside a job then stay on that thread
+ * instead of all jobs queueing for the global pool.
+ */
+class SerialKernelScope {
+public:
+    SerialKernelScope();
+    ~SerialKernelScope();
+
+    SerialKernelScope(const SerialKernelScope&) = delete;
+    SerialKernelScope& operator=(const SerialKernelScope&) = delete;
+
+private:
+    bool m_previous;
+};
+
+// --- Runtime control of the library's thread count ---
+
+// Sets the number of threads used by parallel kernels (1 = serial)
+void set_num_threads(size_t num_threads);
+
+// Returns the number of threads used by parallel kernels
+size_t get_num_threads();
+
+// --- Contiguous block split of a loop over [0, n) ---
+
+// Below this much work (vector entries, stored non-zeros, ...) a kernel stays
+// on one thread: waking the pool costs more than the pass itself
+const size_t kParallelMinWork = 20000;
+
+/**
+ * @brief Number of blocks a pass over 'work' units (entries, nonzeros, ...)
+ * should be split into: the pool size, or 1 (serial) when the pool has a
+ * single thread or work < min_work, where threading costs more than it saves.
+ */
+size_t parallel_block_count(size_t work, size_t min_work = kParallelMinWork);
+
+/**
+ * @brief Calls fn(begin, end, block) for num_blocks contiguous blocks of
+ * [0, n), one per pool thread; num_blocks comes from parallel_block_count.
+ *
+ * The split is static, so per-block partial sums combined by the caller in
+ * block order give the same result on every run. A nested call runs as the
+ * single block [0, n), so callers should zero their partials first.
+ */
+template <class Fn>
+void parallel_blocks(size_t n, size_t num_blocks, Fn fn) {
+    if (num_blocks <= 1) {
+        fn(size_t(0), n, size_t(0));
+        return;
+    }
+    ThreadPool::global().run([&](size_t tid, size_t num_threads) {
+        fn(n * tid / num_threads, n * (tid + 1) / num_threads, tid);
+    });
+}
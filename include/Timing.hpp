@@ -0,0 +1,13 @@
+// in file: include/Timing.hpp
+#pragma once
+
+// Wall-clock timing for the SolveReport phase times (internal to the library).
+
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+// Seconds elapsed since 'start'
+inline double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
@@ -0,0 +1,122 @@
+// in file: include/VectorExpression.hpp
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * Expression templates for Vector arithmetic.
+ *
+ * Writing x + (p * alpha) used to build one full temporary Vector per
+ * operator. Here each operator instead returns a small "expression" object
+ * that only remembers its operands. Nothing is computed until the
+ * expression is assigned to a Vector; then the whole chain is evaluated in
+ * ONE loop, element by element, with no temporaries at all:
+ *
+ *     x = x + p * alpha;   // one pass: x[i] = x[i] + p[i] * alpha
+ *
+ * Because every operation is element-wise, it is safe for the target to
+ * appear on the right-hand side (as x does above).
+ *
+ * Note: an expression holds references to the Vectors it was built from,
+ * so it must be evaluated before those Vectors go away. Assign it to a
+ * Vector (or pass it to a function taking const Vector&) instead of keeping
+ * it in an 'auto' variable.
+ */
+
+class Vector;
+
+/**
+ * @class VectorExpression
+ * @brief CRTP base of everything that can appear in a Vector expression.
+ *
+ * E must provide size() and eval(i), which returns element i of the result.
+ */
+template <class E>
+class VectorExpression {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// How an operand is stored inside an expression node:
+// Vectors by reference (no copy), other expression nodes by value (they are tiny).
+template <class E>
+struct ExpressionOperand {
+    typedef const E type;
+};
+
+template <>
+struct ExpressionOperand<Vector> {
+    typedef const Vector& type;
+};
+
+// --- Expression Nodes ---
+
+// lhs + rhs
+template <class L, class R>
+class VectorSum : public VectorExpression<VectorSum<L, R> > {
+public:
+    VectorSum(const L& lhs, const R& rhs) : m_lhs(lhs), m_rhs(rhs) {
+        if (lhs.size() != rhs.size()) {
+            throw std::length_error("Vectors must be of the same size to add.");
+        }
+    }
+    size_t size() const { return m_lhs.size(); }
+    double eval(size_t i) const { return m_lhs.eval(i) + m_rhs.eval(i); }
+
+private:
+    typename ExpressionOperand<L>::type m_lhs;
+    typename ExpressionOperand<R>::type m_rhs;
+};
+
+// lhs - rhs
+template <class L, class R>
+class VectorDifference : public VectorExpression<VectorDifference<L, R> > {
+public:
+    VectorDifference(const L& lhs, const R& rhs) : m_lhs(lhs), m_rhs(rhs) {
+        if (lhs.size() != rhs.size()) {
+            throw std::length_error("Vectors must be of the same size to subtract.");
+        }
+    }
+    size_t size() const { return m_lhs.size(); }
+    double eval(size_t i) const { return m_lhs.eval(i) - m_rhs.eval(i); }
+
+private:
+    typename ExpressionOperand<L>::type m_lhs;
+    typename ExpressionOperand<R>::type m_rhs;
+};
+
+// expr * scalar
+template <class E>
+class VectorScaled : public VectorExpression<VectorScaled<E> > {
+public:
+    VectorScaled(const E& expr, double scalar) : m_expr(expr), m_scalar(scalar) {}
+    size_t size() const { return m_expr.size(); }
+    double eval(size_t i) const { return m_expr.eval(i) * m_scalar; }
+
+private:
+    typename ExpressionOperand<E>::type m_expr;
+    double m_scalar;
+};
+
+// --- Operators (they only build nodes; evaluation happens on assignment) ---
+
+template <class L, class R>
+inline VectorSum<L, R> operator+(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    return VectorSum<L, R>(lhs.self(), rhs.self());
+}
+
+template <class L, class R>
+inline VectorDifference<L, R> operator-(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    return VectorDifference<L, R>(lhs.self(), rhs.self());
+}
+
+template <class E>
+inline VectorScaled<E> operator*(const VectorExpression<E>& expr, double scalar) {
+    return VectorScaled<E>(expr.self(), scalar);
+}
+
+template <class E>
+inline VectorScaled<E> operator*(double scalar, const VectorExpression<E>& expr) {
+    return VectorScaled<E>(expr.self(), scalar);
+}
@@ -3,8 +3,12 @@
 // in file: include/cfd.hpp
 
 #include "SparseMatrix.hpp"
+#include "LinearOperator.hpp"
+#include "Preconditioner.hpp"
 #include "vector.hpp"
 #include <cmath> // so we can use square root
+#include <vector>
+#include <iosfwd>
 
 void hello_cfd();
 
@@ -12,7 +16,137 @@ void hello_cfd();
 double dot_product(const Vector& a, const Vector& b);
 double norm(const Vector& a);
 
+// Reusable scratch vectors for solve_cg.
+// Keep one alive across solves and the solver allocates nothing after the first call.
+struct CGWorkspace {
+    Vector r;  // residual
+    Vector z;  // preconditioned residual (used by solve_pcg only)
+    Vector p;  // search direction
+    Vector Ap; // A * p
+
+    // Extra recurrence vectors of the pipelined variant (A r and A A r)
+    Vector w;
+    Vector q;
+
+    // Krylov basis [p, A p, ..., A^s p, r, A r, ..., A^(s-1) r] of the s-step variant
+    std::vector<Vector> basis;
+
+    // Sizes all vectors for an n-unknown problem (no-op if already that size)
+    void resize(size_t n);
+};
+
+// --- Solve reports and convergence monitors ---
+
+// Why a solve stopped
+enum class ConvergenceReason {
+    Converged,        // ||r|| < tolerance * ||b||
+    MaxIterations,    // ran out of iterations
+    StoppedByMonitor, // a SolveMonitor asked to stop
+    Breakdown         // p . A p <= 0 (A not SPD) or a non-finite value appeared
+};
+
+const char* to_string(ConvergenceReason reason);
+
+// What a solve did and where the time went.
+// Filled by the solve_cg / solve_pcg overloads that return a SolveReport.
+struct SolveReport {
+    size_t iterations = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    double initial_residual = 0.0;       // ||b - A x0||
+    double final_residual = 0.0;         // ||r|| when the solve stopped
+    std::vector<double> residual_history; // ||r_k|| for k = 0 .. iterations
+
+    // alpha_k and beta_k of every iteration of the classic and preconditioned
+    // CG (empty for the other solvers). They define the Lanczos tridiagonal
+    // of A (or M^-1 A); see spectrum_from_cg in Chebyshev.hpp.
+    std::vector<double> cg_alpha;
+    std::vector<double> cg_beta;
+
+    // Wall-clock seconds per phase. Fused kernels (r -= alpha Ap with r . r)
+    // count as vector updates.
+    double time_spmv = 0.0;
+    double time_dot = 0.0;
+    double time_update = 0.0;
+    double time_preconditioner = 0.0;
+    double time_total = 0.0;
+
+    bool converged() const { return reason == ConvergenceReason::Converged; }
+};
+
+// Writes a short summary: iterations, reason, residuals and the time split
+std::ostream& operator<<(std::ostream& out, const SolveReport& report);
+
+// Snapshot passed to a SolveMonitor after every iteration
+struct IterationState {
+    size_t iteration;         // iterations completed so far (1, 2, ...)
+    double residual_norm;     // ||r||
+    double relative_residual; // ||r|| / ||b||
+    const Vector& x;          // current iterate
+    const Vector& r;          // current residual
+};
+
+// Observer for custom logging or stopping criteria.
+// onIteration() returns false to stop the solve (reason StoppedByMonitor).
+class SolveMonitor {
+public:
+    virtual ~SolveMonitor() {}
+    virtual bool onIteration(const IterationState& state) = 0;
+};
+
+// Prints "Iteration k: Residual norm = ..." every `every` iterations (never stops the solve)
+class PrintingMonitor : public SolveMonitor {
+public:
+    explicit PrintingMonitor(std::ostream& out, size_t every = 1);
+    bool onIteration(const IterationState& state);
+
+private:
+    std::ostream& m_out;
+    size_t m_every;
+};
+
 // The Conjugate Gradient Solver Function
-Vector solve_cg(const SparseMatrix& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance);
+// A can be any LinearOperator: SparseMatrix, SellMatrix, MappedSparseMatrix or a
+// matrix-free stencil operator.
+Vector solve_cg(const LinearOperator& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance);
+
+// Allocation-free variant: x holds the initial guess on entry and the solution on exit.
+// Returns the number of iterations performed (max_iter if it did not converge).
+// This is the fast path: no timers, no history, no output.
+size_t solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance, CGWorkspace& workspace);
+
+// Instrumented variant: same solve, plus a SolveReport. monitor may be null.
+SolveReport solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                     CGWorkspace& workspace, SolveMonitor* monitor);
+
+// --- CG variants for many-core runs ---
+// Classic CG has two global reductions (dot products) per iteration, and each one
+// is a synchronization point for all threads.
+//  - Pipelined (Ghysels-Vanroose): one fused reduction per iteration that does
+//    not depend on the SpMV of the same iteration, so the two can overlap.
+//    Needs 3 more vectors and one fused update pass per iteration.
+//  - SStep (communication avoiding, Chronopoulos-Gear / Carson-Demmel): builds
+//    the Krylov basis for s iterations, computes its Gram matrix with ONE
+//    reduction, then does s iterations on small (2s+1)-sized coordinate vectors.
+//    Costs 2s SpMVs per s iterations.
+// Both drift from the true residual in finite precision; residual replacement
+// recomputes r = b - A x (and the auxiliary vectors) periodically to stay stable.
+enum class CGVariant { Classic, Pipelined, SStep };
+
+struct CGVariantOptions {
+    CGVariant variant = CGVariant::Classic;
+    size_t s = 4;                    // s-step block size (monomial basis: keep it <= 8)
+    size_t residual_replacement = 0; // recompute the true residual every N iterations (0 = never)
+};
 
+// Same as the solve_cg overloads above, with the algorithm selected by options
+size_t solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                CGWorkspace& workspace, const CGVariantOptions& options);
+SolveReport solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                     CGWorkspace& workspace, const CGVariantOptions& options, SolveMonitor* monitor);
 
+// Preconditioned Conjugate Gradient: same interface as solve_cg plus a preconditioner M
+// (e.g. JacobiPreconditioner, SSORPreconditioner, IC0Preconditioner from Preconditioner.hpp)
+Vector solve_pcg(const LinearOperator& A, const Vector& b, const Vector& x0, const Preconditioner& M, size_t max_iter, double tolerance);
+size_t solve_pcg(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M, size_t max_iter, double tolerance, CGWorkspace& workspace);
+SolveReport solve_pcg(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M, size_t max_iter, double tolerance,
+                      CGWorkspace& workspace, SolveMonitor* monitor);
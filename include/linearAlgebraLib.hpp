@@ -7,6 +7,27 @@
  * and the Conjugate Gradient Solver.
  */
 
+#include "Memory.hpp"
 #include "vector.hpp"
+#include "MultiVector.hpp"
 #include "SparseMatrix.hpp"
+#include "SparseMatrixBuilder.hpp"
+#include "SymmetricSparseMatrix.hpp"
+#include "ThreadPool.hpp"
+#include "SellMatrix.hpp"
+#include "Preconditioner.hpp"
+#include "AMG.hpp"
+#include "MatrixIO.hpp"
+#include "LinearOperator.hpp"
+#include "Stencil.hpp"
+#include "CompactCsrMatrix.hpp"
+#include "DeltaCsrMatrix.hpp"
+#include "BsrMatrix.hpp"
+#include "MixedPrecision.hpp"
+#include "BlockCG.hpp"
+#include "Reordering.hpp"
+#include "CGSolver.hpp"
+#include "BatchSolver.hpp"
+#include "Krylov.hpp"
+#include "Chebyshev.hpp"
 #include "cfd.hpp"
@@ -3,6 +3,8 @@
 
 #include <vector>  // For using std::vector internally
 #include <cstddef> // For using size_t, which is the standard type for array indexing and sizes
+#include "VectorExpression.hpp" // Lazy +, - and * (expression templates)
+#include "Memory.hpp"           // Aligned, pooled storage (DoubleArray)
 
 /**
  * @class Vector
@@ -12,8 +14,17 @@
  * std::vector for its underlying data storage. It's designed to
  * be intuitive for mathematical operations by overloading common
  * arithmetic operators.
+ *
+ * The storage is a DoubleArray (see Memory.hpp): 64-byte aligned, taken
+ * from the default memory pool so temporaries are recycled instead of
+ * malloc'd, and initialized in parallel so that on a NUMA machine each
+ * thread's block of the vector lives on that thread's node.
+ *
+ * The arithmetic operators (+, -, * scalar) are expression templates (see
+ * VectorExpression.hpp): a chain like a + b * 2.0 is evaluated in a single
+ * loop when it is assigned, without building temporary Vectors.
  */
-class Vector {
+class Vector : public VectorExpression<Vector> {
 public:
     // --- 1. Constructors (The "birth" of an object) ---
 
@@ -34,6 +45,13 @@ public:
      */
     Vector(const std::vector<double>& data);
 
+    /**
+     * @brief Creates a vector by evaluating an expression such as a + b * 2.0.
+     * @param expr The expression; it is evaluated in one pass.
+     */
+    template <class E>
+    Vector(const VectorExpression<E>& expr);
+
 
     // --- 2. The Rule of Three/Five (Managing copies and memory) ---
 
@@ -68,6 +86,15 @@ public:
      */
     Vector& operator=(Vector&& other) noexcept;
 
+    /**
+     * @brief Evaluates an expression into this vector in a single loop.
+     * The vector may appear in the expression itself (e.g. x = x + p * alpha).
+     * @param expr The expression to evaluate.
+     * @return A reference to this instance.
+     */
+    template <class E>
+    Vector& operator=(const VectorExpression<E>& expr);
+
 
     // --- 3. Public Methods / API (The "interface") ---
 
@@ -78,6 +105,54 @@ public:
      */
     size_t size() const;
 
+    /**
+     * @brief Direct access to the underlying contiguous storage.
+     * @return A pointer to the first element (no bounds checking).
+     * Used by performance-critical kernels such as SpMV.
+     */
+    double* data();
+
+    /**
+     * @brief Direct read-only access to the underlying contiguous storage.
+     */
+    const double* data() const;
+
+    /**
+     * @brief Changes the number of elements. New elements are set to zero.
+     * Keeps the existing buffer when it is already large enough.
+     */
+    void resize(size_t size);
+
+    /**
+     * @brief Copies the values of another vector into this one's storage.
+     * Unlike operator=, no new buffer is allocated when the sizes already match.
+     */
+    void copyFrom(const Vector& other);
+
+
+    // --- In-place BLAS-1 kernels (no temporaries, one pass over memory) ---
+
+    /**
+     * @brief this = this + alpha * x  ("axpy")
+     */
+    void axpy(double alpha, const Vector& x);
+
+    /**
+     * @brief this = x + beta * this  ("xpay"), e.g. the CG direction update p = r + beta * p
+     */
+    void xpay(const Vector& x, double beta);
+
+    /**
+     * @brief this = alpha * this
+     */
+    void scale(double alpha);
+
+    /**
+     * @brief Fused this = this + alpha * x followed by a dot product with itself.
+     * @return The updated this · this, computed in the same pass as the update.
+     */
+    double axpyDot(double alpha, const Vector& x);
+
 
     // --- 4. Operator Overloading (Making the class intuitive) ---
 
@@ -96,31 +171,49 @@ public:
     const double& operator[](size_t index) const;
 
     /**
-     * @brief Vector addition.
-     * @param rhs The vector on the "right-hand side" of the + operator.
-     * @return A new Vector object that is the sum of the two vectors.
+     * @brief Element i without bounds checking (used when evaluating expressions).
      */
-    Vector operator+(const Vector& rhs) const;
+    double eval(size_t index) const { return m_data[index]; }
 
-    /**
-     * @brief Vector subtraction.
-     * @param rhs The vector on the "right-hand side" of the - operator.
-     * @return A new Vector object that is the result of the subtraction.
-     */
-    Vector operator-(const Vector& rhs) const;
-
-    /**
-     * @brief Scalar multiplication (vector * scalar).
-     * @param scalar The scalar value to multiply by.
-     * @return A new Vector object where each element is multiplied by the scalar.
-     */
-    Vector operator*(double scalar) const;
+    // Vector addition (a + b), subtraction (a - b) and scalar multiplication
+    // (a * s, s * a) are the free operator templates in VectorExpression.hpp.
 
 
 private:
     // --- 5. Private Member Variables ---
 
     // The internal data storage. We use std::vector because it handles
-    // all the difficult memory management (allocation/deallocation) for us.
-    std::vector<double> m_data;
-};
\ No newline at end of file
+    // all the difficult memory management (allocation/deallocation) for us;
+    // its allocator supplies the aligned, pooled memory.
+    DoubleArray m_data;
+};
+
+// --- Expression Template Evaluation ---
+// Defined in the header because they are templates.
+
+template <class E>
+Vector::Vector(const VectorExpression<E>& expr) : m_data(expr.self().size()) {
+    const E& e = expr.self();
+    double* out = m_data.data();
+    const size_t n = m_data.size();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = e.eval(i);
+    }
+}
+
+template <class E>
+Vector& Vector::operator=(const VectorExpression<E>& expr) {
+    const E& e = expr.self();
+    // Every node reads element i only, so writing element i in place is safe.
+    // If the sizes differ this vector cannot be an operand, so resizing is safe too
+    // (the new elements are left uninitialized; the loop below writes them all).
+    if (m_data.size() != e.size()) {
+        m_data.resize(e.size());
+    }
+    double* out = m_data.data();
+    const size_t n = m_data.size();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = e.eval(i);
+    }
+    return *this;
+}
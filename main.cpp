@@ -95,7 +95,12 @@ int main() {
         double tolerance = 1e-6; 
 
         // 2. Solve the system
-        Vector x_solution = solve_cg(A, b, x0, max_iterations, tolerance);
+        // The monitor prints the residual every iteration; the report summarizes the solve
+        Vector x_solution = x0;
+        CGWorkspace workspace;
+        PrintingMonitor monitor(std::cout);
+        SolveReport report = solve_cg(A, b, x_solution, max_iterations, tolerance, workspace, &monitor);
+        std::cout << report;
 
         // 3. Print Final Result
         std::cout << "\nCG SOLVER TEST RESULT:" << std::endl;
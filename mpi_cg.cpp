@@ -0,0 +1,156 @@
+// in file: mpi_cg.cpp
+//
+// Distributed CG on a 2D Poisson problem, checked against the serial solver.
+//
+// Build and run (needs an MPI installation; runs fine on a single machine):
+//     make mpi_cg
+//     mpirun -np 4 ./mpi_cg --grid 200
+//
+// Every rank builds the same global matrix, keeps its block of rows and the
+// distributed solve_cg runs twice: with the Ordered reduction (must match the
+// serial solve_cg bit for bit) and with Allreduce (may differ by one
+// iteration and agree within the tolerance). Exit code 1 on a mismatch.
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include "linearAlgebraLib.hpp"
+#include "DistributedMatrix.hpp"
+
+namespace {
+
+struct Options {
+    size_t grid = 200;      // grid points per direction (grid^2 unknowns)
+    size_t max_iter = 5000;
+    double tolerance = 1e-8;
+    bool check = true;      // also run the serial solve on every rank and compare
+};
+
+void print_usage() {
+    std::cout <<
+        "Usage: mpirun -np N mpi_cg [options]\n"
+        "  --grid N        grid points per direction (default 200)\n"
+        "  --max-iter N    CG iteration limit (default 5000)\n"
+        "  --tol X         relative residual tolerance (default 1e-8)\n"
+        "  --no-check      skip the serial reference solve\n";
+}
+
+Options parse_options(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-check") {
+            opt.check = false;
+        } else if (i + 1 < argc && arg == "--grid") {
+            opt.grid = std::strtoul(argv[++i], 0, 10);
+        } else if (i + 1 < argc && arg == "--max-iter") {
+            opt.max_iter = std::strtoul(argv[++i], 0, 10);
+        } else if (i + 1 < argc && arg == "--tol") {
+            opt.tolerance = std::strtod(argv[++i], 0);
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (opt.grid == 0) {
+        throw std::invalid_argument("--grid must be positive");
+    }
+    return opt;
+}
+
+double max_abs_difference(const Vector& a, const Vector& b) {
+    double diff = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int status = 0;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (std::string(argv[i]) == "--help") {
+                if (rank == 0) print_usage();
+                MPI_Finalize();
+                return 0;
+            }
+        }
+        Options opt = parse_options(argc, argv);
+
+        SparseMatrix global = poisson_matrix_2d(opt.grid, opt.grid);
+        const size_t n = global.rows();
+        Vector b_global(n);
+        for (size_t i = 0; i < n; ++i) b_global[i] = 1.0;
+
+        DistributedMatrix A = DistributedMatrix::distribute(MPI_COMM_WORLD, global);
+        DistributedVector b = A.createVector();
+        b.scatter(b_global);
+
+        if (rank == 0) {
+            std::cout << "--- Distributed CG: " << n << " unknowns on " << size << " rank(s) ---" << std::endl;
+        }
+        std::cout << "rank " << rank << ": rows [" << A.rowBegin() << ", " << A.rowEnd() << "), "
+                  << A.interiorRows() << " interior, " << A.boundaryRows() << " boundary, "
+                  << A.ghostCount() << " ghosts" << std::endl;
+
+        Vector x_serial(n);
+        SolveReport serial;
+        if (opt.check) {
+            CGWorkspace workspace;
+            serial = solve_cg(global, b_global, x_serial, opt.max_iter, opt.tolerance, workspace, nullptr);
+        }
+
+        const DistributedReduction modes[] = { DistributedReduction::Ordered, DistributedReduction::Allreduce };
+        const char* names[] = { "ordered", "allreduce" };
+        for (int m = 0; m < 2; ++m) {
+            DistributedVector x = A.createVector();
+            DistributedCGOptions options;
+            options.reduction = modes[m];
+            MPI_Barrier(MPI_COMM_WORLD);
+            SolveReport report = solve_cg(A, b, x, opt.max_iter, opt.tolerance, options);
+            Vector x_all = x.gather();
+
+            if (rank == 0) {
+                std::cout << names[m] << ": " << report.iterations << " iterations, "
+                          << report.time_total << " s (spmv " << report.time_spmv
+                          << " s, dot " << report.time_dot << " s)";
+            }
+            if (opt.check) {
+                const double diff = max_abs_difference(x_all, x_serial);
+                bool ok;
+                if (modes[m] == DistributedReduction::Ordered) {
+                    ok = report.iterations == serial.iterations && diff == 0.0 &&
+                         report.residual_history == serial.residual_history;
+                } else {
+                    // Reordered sums: the iteration count may differ by one, x within the tolerance
+                    const size_t gap = std::max(report.iterations, serial.iterations) -
+                                       std::min(report.iterations, serial.iterations);
+                    const double scale = max_abs_difference(x_serial, Vector(n));
+                    ok = gap <= 1 && diff <= 100.0 * opt.tolerance * scale;
+                }
+                if (rank == 0) {
+                    std::cout << ", serial " << serial.iterations << " iterations, max |x - x_serial| = "
+                              << diff << (ok ? "  OK" : "  MISMATCH");
+                }
+                if (!ok) status = 1;
+            }
+            if (rank == 0) std::cout << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "rank " << rank << ": An error occurred: " << e.what() << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Finalize();
+    return status;
+}
@@ -0,0 +1,465 @@
+// in file: src/AMG.cpp
+#include "AMG.hpp"
+#include "SparseMatrixBuilder.hpp"
+#include "cfd.hpp" // For norm
+#include "Timing.hpp"
+#include <stdexcept>
+#include <cmath>
+#include <iomanip>
+#include <utility> // For std::move
+#include <algorithm> // For std::max
+
+namespace {
+
+const size_t kNone = static_cast<size_t>(-1);
+
+// Diagonal of a matrix (entries summed, zero if missing)
+std::vector<double> diagonal_of(const SparseMatrix& A) {
+    const IndexArray& offsets = A.rowOffsets();
+    const IndexArray& cols = A.colIndices();
+    const DoubleArray& vals = A.values();
+    std::vector<double> diag(A.rows(), 0.0);
+    for (size_t i = 0; i < A.rows(); ++i) {
+        for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+            if (cols[k] == i) {
+                diag[i] += vals[k];
+            }
+        }
+    }
+    return diag;
+}
+
+// Upper bound for the largest eigenvalue of D^-1 A (Gershgorin circles):
+// lambda_max <= max_i sum_j |a_ij| / |a_ii|. Power iterations tend to
+// underestimate lambda_max, which makes Chebyshev smoothing diverge; this
+// bound is cheap, safe, and exact for M-matrices with zero row sums.
+double estimate_lambda_max(const SparseMatrix& A, const std::vector<double>& inv_diag) {
+    const IndexArray& offsets = A.rowOffsets();
+    const DoubleArray& vals = A.values();
+    double lambda = 0.0;
+    for (size_t i = 0; i < A.rows(); ++i) {
+        double row_sum = 0.0;
+        for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+            row_sum += std::fabs(vals[k]);
+        }
+        lambda = std::max(lambda, row_sum * std::fabs(inv_diag[i]));
+    }
+    return lambda > 0.0 ? lambda : 1.0;
+}
+
+void set_zero(Vector& v) {
+    double* p = v.data();
+    for (size_t i = 0; i < v.size(); ++i) {
+        p[i] = 0.0;
+    }
+}
+
+} // namespace
+
+// --- Setup ---
+
+const size_t AMGHierarchy::kMaxDenseCoarseRows;
+const size_t AMGHierarchy::kCoarseSmoothingSweeps;
+
+AMGHierarchy::AMGHierarchy(const SparseMatrix& A, const Options& options)
+    : m_options(options), m_coarse_n(0) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("AMG requires a square matrix");
+    }
+    if (options.max_levels == 0) {
+        throw std::invalid_argument("AMG needs at least one level");
+    }
+
+    // Reserved up front so the Level::A pointers into it stay valid
+    m_coarse_matrices.reserve(options.max_levels);
+
+    const SparseMatrix* current = &A;
+    while (true) {
+        Clock::time_point start = Clock::now();
+        const SparseMatrix& Al = *current;
+        const size_t n = Al.rows();
+
+        Level level;
+        level.A = current;
+        level.inv_diag = diagonal_of(Al);
+        for (size_t i = 0; i < n; ++i) {
+            if (level.inv_diag[i] == 0.0) {
+                throw std::runtime_error("AMG requires a non-zero diagonal on every level");
+            }
+            level.inv_diag[i] = 1.0 / level.inv_diag[i];
+        }
+        level.lambda_max = estimate_lambda_max(Al, level.inv_diag);
+        level.residual.resize(n);
+        level.correction.resize(n);
+
+        LevelStats stats;
+        stats.rows = n;
+        stats.nnz = Al.nnz();
+        stats.solve_seconds = 0.0;
+        stats.cycles = 0;
+
+        bool coarsest = n <= options.coarse_size || m_levels.size() + 1 >= options.max_levels;
+
+        size_t num_aggregates = 0;
+        std::vector<size_t> aggregate(n, kNone);
+        std::vector<size_t> strong_offsets(n + 1, 0);
+        std::vector<size_t> strong_cols;
+        const IndexArray& offsets = Al.rowOffsets();
+        const IndexArray& cols = Al.colIndices();
+        const DoubleArray& vals = Al.values();
+
+        if (!coarsest) {
+            // 1. Strength of connection (symmetric test)
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    size_t j = cols[k];
+                    if (j != i && std::fabs(vals[k]) >= options.strength_threshold *
+                            std::sqrt(std::fabs(1.0 / (level.inv_diag[i] * level.inv_diag[j])))) {
+                        strong_cols.push_back(j);
+                    }
+                }
+                strong_offsets[i + 1] = strong_cols.size();
+            }
+
+            // 2. Aggregation
+            // Phase 1: a node whose strong neighbours are all free seeds a new aggregate
+            for (size_t i = 0; i < n; ++i) {
+                if (aggregate[i] != kNone) {
+                    continue;
+                }
+                bool all_free = true;
+                for (size_t k = strong_offsets[i]; k < strong_offsets[i + 1] && all_free; ++k) {
+                    all_free = aggregate[strong_cols[k]] == kNone;
+                }
+                if (all_free) {
+                    aggregate[i] = num_aggregates;
+                    for (size_t k = strong_offsets[i]; k < strong_offsets[i + 1]; ++k) {
+                        aggregate[strong_cols[k]] = num_aggregates;
+                    }
+                    ++num_aggregates;
+                }
+            }
+            // Phase 2: leftover nodes join an aggregate of a strong neighbour
+            std::vector<size_t> phase1 = aggregate;
+            for (size_t i = 0; i < n; ++i) {
+                if (aggregate[i] != kNone) {
+                    continue;
+                }
+                for (size_t k = strong_offsets[i]; k < strong_offsets[i + 1]; ++k) {
+                    if (phase1[strong_cols[k]] != kNone) {
+                        aggregate[i] = phase1[strong_cols[k]];
+                        break;
+                    }
+                }
+            }
+            // Phase 3: whatever is still free forms new aggregates with its free neighbours
+            for (size_t i = 0; i < n; ++i) {
+                if (aggregate[i] != kNone) {
+                    continue;
+                }
+                aggregate[i] = num_aggregates;
+                for (size_t k = strong_offsets[i]; k < strong_offsets[i + 1]; ++k) {
+                    if (aggregate[strong_cols[k]] == kNone) {
+                        aggregate[strong_cols[k]] = num_aggregates;
+                    }
+                }
+                ++num_aggregates;
+            }
+
+            // No real coarsening possible: treat this level as the coarsest
+            if (num_aggregates == 0 || num_aggregates >= n) {
+                coarsest = true;
+            }
+        }
+
+        if (coarsest && n > std::max(options.coarse_size, kMaxDenseCoarseRows)) {
+            // Coarsening stalled or ran out of levels on a large matrix: a dense
+            // factorization would need n^2 memory and n^3 time, so coarseSolve
+            // smooths instead (m_coarse_n stays 0)
+            stats.setup_seconds = seconds_since(start);
+            m_levels.push_back(std::move(level));
+            m_stats.push_back(stats);
+            break;
+        }
+
+        if (coarsest) {
+            // Dense Cholesky factorization of the coarsest matrix
+            m_coarse_n = n;
+            m_coarse_cholesky.assign(n * n, 0.0);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    m_coarse_cholesky[i * n + cols[k]] += vals[k];
+                }
+            }
+            std::vector<double>& L = m_coarse_cholesky;
+            for (size_t j = 0; j < n; ++j) {
+                double d = L[j * n + j];
+                for (size_t k = 0; k < j; ++k) {
+                    d -= L[j * n + k] * L[j * n + k];
+                }
+                if (!(d > 0.0)) {
+                    throw std::runtime_error("AMG coarse matrix is not positive definite");
+                }
+                L[j * n + j] = std::sqrt(d);
+                for (size_t i = j + 1; i < n; ++i) {
+                    double s = L[i * n + j];
+                    for (size_t k = 0; k < j; ++k) {
+                        s -= L[i * n + k] * L[j * n + k];
+                    }
+                    L[i * n + j] = s / L[j * n + j];
+                }
+                for (size_t i = 0; i < j; ++i) {
+                    L[i * n + j] = 0.0; // keep only the lower triangle
+                }
+            }
+
+            stats.setup_seconds = seconds_since(start);
+            m_levels.push_back(std::move(level));
+            m_stats.push_back(stats);
+            break;
+        }
+
+        // 3. Tentative prolongator: piecewise constant, each column normalized
+        std::vector<double> aggregate_size(num_aggregates, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            aggregate_size[aggregate[i]] += 1.0;
+        }
+        SparseMatrixBuilder p0(n, num_aggregates);
+        p0.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            p0.addValue(i, aggregate[i], 1.0 / std::sqrt(aggregate_size[aggregate[i]]));
+        }
+        SparseMatrix P0 = p0.build();
+
+        // 4. Smoother S = I - w D_F^-1 A_F on the filtered matrix A_F
+        // (weak connections are dropped and lumped onto the diagonal)
+        std::vector<double> filtered_diag(n, 0.0);
+        SparseMatrixBuilder af(n, n);
+        af.reserve(strong_cols.size() + n);
+        for (size_t i = 0; i < n; ++i) {
+            // strong_cols lists the strong entries of row i in the same order as the row itself
+            size_t s = strong_offsets[i];
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                size_t j = cols[k];
+                if (s < strong_offsets[i + 1] && strong_cols[s] == j) {
+                    af.addValue(i, j, vals[k]);
+                    ++s;
+                } else {
+                    filtered_diag[i] += vals[k]; // diagonal or weak connection
+                }
+            }
+            af.addValue(i, i, filtered_diag[i]);
+        }
+        SparseMatrix AF = af.build();
+        std::vector<double> inv_filtered_diag(n);
+        for (size_t i = 0; i < n; ++i) {
+            inv_filtered_diag[i] = filtered_diag[i] != 0.0 ? 1.0 / filtered_diag[i] : 0.0;
+        }
+        double omega = 4.0 / (3.0 * estimate_lambda_max(AF, inv_filtered_diag));
+
+        SparseMatrixBuilder sb(n, n);
+        sb.reserve(AF.nnz() + n);
+        {
+            const IndexArray& f_offsets = AF.rowOffsets();
+            const IndexArray& f_cols = AF.colIndices();
+            const DoubleArray& f_vals = AF.values();
+            for (size_t i = 0; i < n; ++i) {
+                sb.addValue(i, i, 1.0);
+                for (size_t k = f_offsets[i]; k < f_offsets[i + 1]; ++k) {
+                    sb.addValue(i, f_cols[k], -omega * inv_filtered_diag[i] * f_vals[k]);
+                }
+            }
+        }
+        SparseMatrix S = sb.build();
+
+        // 5. Smoothed prolongator, restriction and Galerkin coarse operator
+        level.P = S * P0;
+        level.R = level.P.transpose();
+        m_coarse_matrices.push_back(level.R * (Al * level.P));
+        level.coarse_rhs.resize(num_aggregates);
+        level.coarse_x.resize(num_aggregates);
+
+        stats.setup_seconds = seconds_since(start);
+        m_levels.push_back(std::move(level));
+        m_stats.push_back(stats);
+        current = &m_coarse_matrices.back();
+    }
+}
+
+// --- Solve Phase ---
+
+// Smoothing on one level: damped Jacobi or a Chebyshev polynomial in D^-1 A
+// Both smoothers are symmetric, so the same routine serves for pre- and post-smoothing
+void AMGHierarchy::smooth(const Level& level, const Vector& b, Vector& x) const {
+    const SparseMatrix& A = *level.A;
+    const size_t n = A.rows();
+    Vector& r = level.residual;
+    Vector& d = level.correction;
+    const double* inv_diag = level.inv_diag.data();
+
+    if (m_options.smoother == Jacobi) {
+        for (size_t s = 0; s < m_options.smoothing_steps; ++s) {
+            // x += w D^-1 (b - A x)
+            A.multiply(x, r);
+            r.xpay(b, -1.0);
+            double* px = x.data();
+            const double* pr = r.data();
+            for (size_t i = 0; i < n; ++i) {
+                px[i] += m_options.jacobi_weight * inv_diag[i] * pr[i];
+            }
+        }
+        return;
+    }
+
+    // Chebyshev targets the upper part of the spectrum [lambda_max / 30, 1.1 lambda_max]
+    const double upper = 1.1 * level.lambda_max;
+    const double lower = upper / 30.0;
+    const double theta = 0.5 * (upper + lower);
+    const double delta = 0.5 * (upper - lower);
+    const double sigma = theta / delta;
+    double rho = 1.0 / sigma;
+
+    // r = b - A x, d = D^-1 r / theta
+    A.multiply(x, r);
+    r.xpay(b, -1.0);
+    double* pd = d.data();
+    const double* pr = r.data();
+    for (size_t i = 0; i < n; ++i) {
+        pd[i] = inv_diag[i] * pr[i] / theta;
+    }
+
+    for (size_t k = 1; k <= m_options.chebyshev_degree; ++k) {
+        x.axpy(1.0, d);
+        if (k == m_options.chebyshev_degree) {
+            break;
+        }
+        A.multiply(x, r);
+        r.xpay(b, -1.0);
+        double rho_new = 1.0 / (2.0 * sigma - rho);
+        for (size_t i = 0; i < n; ++i) {
+            pd[i] = rho_new * rho * pd[i] + 2.0 * rho_new / delta * inv_diag[i] * pr[i];
+        }
+        rho = rho_new;
+    }
+}
+
+// Dense forward and backward substitution with the coarse Cholesky factor,
+// or smoothing sweeps when the coarsest level was too large to factor
+void AMGHierarchy::coarseSolve(const Vector& b, Vector& x) const {
+    if (m_coarse_n == 0) {
+        for (size_t s = 0; s < kCoarseSmoothingSweeps; ++s) {
+            smooth(m_levels.back(), b, x);
+        }
+        return;
+    }
+    const size_t n = m_coarse_n;
+    const std::vector<double>& L = m_coarse_cholesky;
+    double* px = x.data();
+    const double* pb = b.data();
+    for (size_t i = 0; i < n; ++i) {
+        double s = pb[i];
+        for (size_t k = 0; k < i; ++k) {
+            s -= L[i * n + k] * px[k];
+        }
+        px[i] = s / L[i * n + i];
+    }
+    for (size_t i = n; i-- > 0; ) {
+        double s = px[i];
+        for (size_t k = i + 1; k < n; ++k) {
+            s -= L[k * n + i] * px[k];
+        }
+        px[i] = s / L[i * n + i];
+    }
+}
+
+// Recursive V-cycle starting at level l
+void AMGHierarchy::cycle(size_t l, const Vector& b, Vector& x) const {
+    Clock::time_point start = Clock::now();
+    const Level& level = m_levels[l];
+    m_stats[l].cycles++;
+
+    if (l + 1 == m_levels.size()) {
+        coarseSolve(b, x);
+        m_stats[l].solve_seconds += seconds_since(start);
+        return;
+    }
+
+    // 1. Pre-smoothing
+    smooth(level, b, x);
+
+    // 2. Restrict the residual: b_c = R (b - A x)
+    level.A->multiply(x, level.residual);
+    level.residual.xpay(b, -1.0);
+    level.R.multiply(level.residual, level.coarse_rhs);
+
+    // 3. Coarse-grid correction (its time is booked on the coarser levels)
+    set_zero(level.coarse_x);
+    Clock::time_point coarse_start = Clock::now();
+    cycle(l + 1, level.coarse_rhs, level.coarse_x);
+    double coarse_seconds = seconds_since(coarse_start);
+
+    // 4. Prolongate and correct: x += P x_c
+    level.P.multiply(level.coarse_x, level.correction);
+    x.axpy(1.0, level.correction);
+
+    // 5. Post-smoothing
+    smooth(level, b, x);
+
+    m_stats[l].solve_seconds += seconds_since(start) - coarse_seconds;
+}
+
+void AMGHierarchy::vcycle(const Vector& b, Vector& x) const {
+    const size_t n = m_levels[0].A->rows();
+    if (b.size() != n || x.size() != n) {
+        throw std::length_error("AMG and Vector sizes must match");
+    }
+    cycle(0, b, x);
+}
+
+size_t AMGHierarchy::solve(const Vector& b, Vector& x, size_t max_iter, double tolerance) const {
+    const Level& fine = m_levels[0];
+    const double b_norm = norm(b);
+    for (size_t k = 0; k < max_iter; ++k) {
+        fine.A->multiply(x, fine.residual);
+        fine.residual.xpay(b, -1.0);
+        if (norm(fine.residual) < tolerance * b_norm) {
+            return k;
+        }
+        vcycle(b, x);
+    }
+    return max_iter;
+}
+
+void AMGHierarchy::apply(const Vector& r, Vector& z) const {
+    set_zero(z);
+    vcycle(r, z);
+}
+
+// --- Statistics ---
+
+double AMGHierarchy::operatorComplexity() const {
+    double total = 0.0;
+    for (size_t l = 0; l < m_stats.size(); ++l) {
+        total += static_cast<double>(m_stats[l].nnz);
+    }
+    return total / static_cast<double>(m_stats[0].nnz);
+}
+
+void AMGHierarchy::resetSolveTimes() const {
+    for (size_t l = 0; l < m_stats.size(); ++l) {
+        m_stats[l].solve_seconds = 0.0;
+        m_stats[l].cycles = 0;
+    }
+}
+
+void AMGHierarchy::printStatistics(std::ostream& out) const {
+    out << "AMG hierarchy: " << m_levels.size() << " levels, operator complexity "
+        << operatorComplexity() << "\n";
+    out << std::setw(6) << "level" << std::setw(12) << "rows" << std::setw(14) << "nnz"
+        << std::setw(14) << "setup [s]" << std::setw(14) << "solve [s]" << std::setw(10) << "visits" << "\n";
+    for (size_t l = 0; l < m_stats.size(); ++l) {
+        out << std::setw(6) << l << std::setw(12) << m_stats[l].rows << std::setw(14) << m_stats[l].nnz
+            << std::setw(14) << m_stats[l].setup_seconds << std::setw(14) << m_stats[l].solve_seconds
+            << std::setw(10) << m_stats[l].cycles << "\n";
+    }
+}
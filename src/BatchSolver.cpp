@@ -0,0 +1,220 @@
+// in file: src/BatchSolver.cpp
+#include "BatchSolver.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <utility> // For std::move
+
+BatchSolver::BatchSolver(const BatchSolverOptions& options)
+    : m_options(options), m_small_queued(0), m_running(0), m_exclusive(false),
+      m_outstanding(0), m_next_queue(0), m_stop(false) {
+    size_t num_threads = m_options.num_threads;
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    for (size_t t = 0; t < num_threads; ++t) {
+        m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (size_t t = 0; t < num_threads; ++t) {
+        m_workers.push_back(std::thread(&BatchSolver::workerLoop, this, t));
+    }
+}
+
+BatchSolver::~BatchSolver() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t t = 0; t < m_workers.size(); ++t) {
+        m_workers[t].join();
+    }
+}
+
+std::future<BatchResult> BatchSolver::submit(BatchJob job) {
+    Task* task = new Task();
+    task->job = std::move(job);
+    std::future<BatchResult> result = task->promise.get_future();
+    enqueue(task);
+    return result;
+}
+
+void BatchSolver::submit(BatchJob job, Callback on_done) {
+    Task* task = new Task();
+    task->job = std::move(job);
+    task->on_done = std::move(on_done);
+    enqueue(task);
+}
+
+std::vector<BatchResult> BatchSolver::solveAll(std::vector<BatchJob> jobs) {
+    std::vector<std::future<BatchResult> > futures;
+    futures.reserve(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        futures.push_back(submit(std::move(jobs[i])));
+    }
+
+    // Collect every result before rethrowing, so no job still refers to the caller's data
+    std::vector<BatchResult> results(futures.size());
+    std::exception_ptr error;
+    for (size_t i = 0; i < futures.size(); ++i) {
+        try {
+            results[i] = futures[i].get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+void BatchSolver::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_outstanding != 0) {
+        m_idle.wait(lock);
+    }
+}
+
+// Validates the job and hands it to a worker deque (small) or the large-job queue
+void BatchSolver::enqueue(Task* task) {
+    std::unique_ptr<Task> owner(task);
+    const BatchJob& job = task->job;
+    if (job.A == nullptr) {
+        throw std::invalid_argument("BatchJob has no operator");
+    }
+    if (job.A->rows() != job.A->cols()) {
+        throw std::invalid_argument("BatchJob requires a square operator");
+    }
+    if (job.b.size() != job.A->rows() || (job.x0.size() != 0 && job.x0.size() != job.A->rows())) {
+        throw std::length_error("Matrix, right-hand side and initial guess sizes must match.");
+    }
+    const bool large = job.A->rows() >= m_options.large_job_rows && ThreadPool::global().size() > 1;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (large) {
+        m_large.push_back(owner.release());
+    } else {
+        WorkerQueue& queue = *m_queues[m_next_queue];
+        m_next_queue = (m_next_queue + 1) % m_queues.size();
+        {
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+            queue.tasks.push_back(owner.release());
+        }
+        ++m_small_queued;
+    }
+    ++m_outstanding;
+    m_wake.notify_one();
+}
+
+// Own deque first (newest job), then steal the oldest job of the others.
+// The caller has claimed one of the queued small jobs, so one is always found.
+BatchSolver::Task* BatchSolver::takeSmall(size_t worker) {
+    const size_t n = m_queues.size();
+    while (true) {
+        {
+            WorkerQueue& own = *m_queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                Task* task = own.tasks.back();
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+        for (size_t step = 1; step < n; ++step) {
+            WorkerQueue& victim = *m_queues[(worker + step) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                Task* task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+    }
+}
+
+void BatchSolver::workerLoop(size_t worker) {
+    CGWorkspace workspace; // reused by every job this worker runs
+    while (true) {
+        bool large = false;
+        Task* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                if (!m_exclusive && !m_large.empty()) {
+                    // Drain: a large job starts once the running jobs have finished
+                    if (m_running == 0) {
+                        task = m_large.front();
+                        m_large.pop_front();
+                        large = true;
+                        m_exclusive = true;
+                        break;
+                    }
+                } else if (!m_exclusive && m_small_queued > 0) {
+                    --m_small_queued;
+                    break;
+                } else if (m_stop && m_outstanding == 0) {
+                    return;
+                }
+                m_wake.wait(lock);
+            }
+            ++m_running;
+        }
+
+        if (large) {
+            execute(task, workspace);
+        } else {
+            task = takeSmall(worker);
+            SerialKernelScope serial;
+            execute(task, workspace);
+        }
+        delete task;
+
+        bool wake_all = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_running;
+            if (large) {
+                m_exclusive = false;
+            }
+            if (--m_outstanding == 0) {
+                m_idle.notify_all();
+            }
+            // The workers held back by a large job, or the one waiting for the drain
+            wake_all = large || (m_running == 0 && !m_large.empty()) || (m_stop && m_outstanding == 0);
+        }
+        if (wake_all) {
+            m_wake.notify_all();
+        }
+    }
+}
+
+void BatchSolver::execute(Task* task, CGWorkspace& workspace) {
+    BatchJob& job = task->job;
+    BatchResult result;
+    try {
+        result.x = job.x0.size() != 0 ? std::move(job.x0) : Vector(job.A->rows());
+        if (job.M != nullptr) {
+            result.report = solve_pcg(*job.A, job.b, result.x, *job.M, job.max_iter, job.tolerance,
+                                      workspace, nullptr);
+        } else {
+            result.report = solve_cg(*job.A, job.b, result.x, job.max_iter, job.tolerance,
+                                     workspace, nullptr);
+        }
+    } catch (...) {
+        result.error = std::current_exception();
+    }
+
+    if (task->on_done) {
+        task->on_done(result);
+    } else if (result.error) {
+        task->promise.set_exception(result.error);
+    } else {
+        task->promise.set_value(std::move(result));
+    }
+}
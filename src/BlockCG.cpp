@@ -0,0 +1,420 @@
+// in file: src/BlockCG.cpp
+#include "BlockCG.hpp"
+#include "ThreadPool.hpp"
+#include "Timing.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <algorithm> // For std::fill, std::max
+
+namespace {
+
+// Sums the per-block m x m partials into G. The row kernels only fill the
+// upper triangle (both Gram matrices the solver needs are symmetric), so the
+// lower triangle is mirrored here.
+void reduce_partials(const std::vector<double>& partial, size_t num_blocks, size_t m, std::vector<double>& G) {
+    G.assign(m * m, 0.0);
+    for (size_t t = 0; t < num_blocks; ++t) {
+        for (size_t e = 0; e < m * m; ++e) {
+            G[e] += partial[t * m * m + e];
+        }
+    }
+    for (size_t a = 0; a < m; ++a) {
+        for (size_t c = 0; c < a; ++c) {
+            G[a * m + c] = G[c * m + a];
+        }
+    }
+}
+
+// --- Row kernels, specialized on the block width ---
+// M > 0 fixes the width at compile time: the per-row loops over the block
+// columns are unrolled and the m x m sums stay in a local array instead of
+// being reloaded through a pointer that might alias the rows. M = 0 handles
+// any width at run time.
+
+// g += U(rows)^T W(rows), upper triangle only
+template <size_t M>
+void gram_rows(const MultiVector& U, const MultiVector& W, size_t begin, size_t end, size_t width, double* g) {
+    const size_t m = M ? M : width;
+    double fixed[M ? M * M : 1];
+    std::vector<double> dynamic(M ? 0 : m * m);
+    double* acc = M ? fixed : dynamic.data();
+    for (size_t e = 0; e < m * m; ++e) acc[e] = 0.0;
+
+    for (size_t i = begin; i < end; ++i) {
+        const double* u = U.row(i);
+        const double* w = W.row(i);
+        for (size_t a = 0; a < m; ++a) {
+            const double ua = u[a];
+            for (size_t c = a; c < m; ++c) {
+                acc[a * m + c] += ua * w[c];
+            }
+        }
+    }
+    for (size_t e = 0; e < m * m; ++e) g[e] += acc[e];
+}
+
+// X += P alpha, R -= Q alpha, g += R_new^T R_new (upper triangle)
+template <size_t M>
+void update_rows(const MultiVector& P, const MultiVector& Q, MultiVector& X, MultiVector& R,
+                 const double* alpha, size_t begin, size_t end, size_t width, double* g) {
+    const size_t m = M ? M : width;
+    double fixed[M ? M * M + 2 * M : 1];
+    std::vector<double> dynamic(M ? 0 : m * m + 2 * m);
+    double* acc = M ? fixed : dynamic.data();
+    double* dx = acc + m * m;
+    double* dr = dx + m;
+    for (size_t e = 0; e < m * m; ++e) acc[e] = 0.0;
+
+    for (size_t i = begin; i < end; ++i) {
+        const double* p = P.row(i);
+        const double* q = Q.row(i);
+        double* x = X.row(i);
+        double* r = R.row(i);
+        for (size_t c = 0; c < m; ++c) {
+            dx[c] = 0.0;
+            dr[c] = 0.0;
+        }
+        for (size_t d = 0; d < m; ++d) {
+            const double pd = p[d];
+            const double qd = q[d];
+            const double* alpha_d = alpha + d * m;
+            for (size_t c = 0; c < m; ++c) {
+                dx[c] += pd * alpha_d[c];
+                dr[c] += qd * alpha_d[c];
+            }
+        }
+        for (size_t c = 0; c < m; ++c) {
+            x[c] += dx[c];
+            dr[c] = r[c] - dr[c];
+            r[c] = dr[c];
+        }
+        for (size_t a = 0; a < m; ++a) {
+            const double ra = dr[a];
+            for (size_t c = a; c < m; ++c) acc[a * m + c] += ra * dr[c];
+        }
+    }
+    for (size_t e = 0; e < m * m; ++e) g[e] += acc[e];
+}
+
+// P = R + P beta
+template <size_t M>
+void direction_rows(MultiVector& P, const MultiVector& R, const double* beta,
+                    size_t begin, size_t end, size_t width) {
+    const size_t m = M ? M : width;
+    double fixed[M ? M : 1];
+    std::vector<double> dynamic(M ? 0 : m);
+    double* tmp = M ? fixed : dynamic.data();
+
+    for (size_t i = begin; i < end; ++i) {
+        double* p = P.row(i);
+        const double* r = R.row(i);
+        for (size_t c = 0; c < m; ++c) tmp[c] = r[c];
+        for (size_t d = 0; d < m; ++d) {
+            const double pd = p[d];
+            const double* beta_d = beta + d * m;
+            for (size_t c = 0; c < m; ++c) tmp[c] += pd * beta_d[c];
+        }
+        for (size_t c = 0; c < m; ++c) p[c] = tmp[c];
+    }
+}
+
+// Expands call(M) with M = width for widths 1..8 and M = 0 (run-time width) otherwise
+#define BLOCK_CG_DISPATCH(width, call) \
+    switch (width) { \
+        case 1: call(1); break; \
+        case 2: call(2); break; \
+        case 3: call(3); break; \
+        case 4: call(4); break; \
+        case 5: call(5); break; \
+        case 6: call(6); break; \
+        case 7: call(7); break; \
+        case 8: call(8); break; \
+        default: call(0); break; \
+    }
+
+// G = U^T W (m x m, row-major) for two n x m row-major blocks whose product
+// is known to be symmetric
+void gram(const MultiVector& U, const MultiVector& W, std::vector<double>& G) {
+    const size_t n = U.rows();
+    const size_t m = U.cols();
+    const size_t blocks = parallel_block_count(n * m);
+    std::vector<double> partial(blocks * m * m, 0.0);
+    parallel_blocks(n, blocks, [&](size_t begin, size_t end, size_t block) {
+        double* g = &partial[block * m * m];
+#define GRAM_CALL(M) gram_rows<M>(U, W, begin, end, m, g)
+        BLOCK_CG_DISPATCH(m, GRAM_CALL)
+#undef GRAM_CALL
+    });
+    reduce_partials(partial, blocks, m, G);
+}
+
+// In-place Cholesky G = L L^T of a small SPD matrix (lower triangle of G holds L).
+// Returns the index of the first pivot that is not clearly positive, or m on success.
+size_t cholesky(std::vector<double>& G, size_t m) {
+    for (size_t j = 0; j < m; ++j) {
+        const double original = G[j * m + j];
+        double d = original;
+        for (size_t k = 0; k < j; ++k) {
+            d -= G[j * m + k] * G[j * m + k];
+        }
+        if (!(d > 1e-14 * std::fabs(original)) || !std::isfinite(d)) {
+            return j;
+        }
+        d = std::sqrt(d);
+        G[j * m + j] = d;
+        for (size_t i = j + 1; i < m; ++i) {
+            double v = G[i * m + j];
+            for (size_t k = 0; k < j; ++k) {
+                v -= G[i * m + k] * G[j * m + k];
+            }
+            G[i * m + j] = v / d;
+        }
+    }
+    return m;
+}
+
+// Solves (L L^T) Y = RHS in place for the m columns of RHS (m x m, row-major)
+void cholesky_solve(const std::vector<double>& L, size_t m, std::vector<double>& rhs) {
+    for (size_t c = 0; c < m; ++c) {
+        for (size_t i = 0; i < m; ++i) {
+            double v = rhs[i * m + c];
+            for (size_t k = 0; k < i; ++k) v -= L[i * m + k] * rhs[k * m + c];
+            rhs[i * m + c] = v / L[i * m + i];
+        }
+        for (size_t i = m; i-- > 0;) {
+            double v = rhs[i * m + c];
+            for (size_t k = i + 1; k < m; ++k) v -= L[k * m + i] * rhs[k * m + c];
+            rhs[i * m + c] = v / L[i * m + i];
+        }
+    }
+}
+
+// Keeps only the listed columns of M
+void keep_columns(MultiVector& M, const std::vector<size_t>& keep) {
+    MultiVector result(M.rows(), keep.size());
+    for (size_t i = 0; i < M.rows(); ++i) {
+        const double* src = M.row(i);
+        double* dst = result.row(i);
+        for (size_t c = 0; c < keep.size(); ++c) dst[c] = src[keep[c]];
+    }
+    M = result;
+}
+
+// Keeps only the listed rows and columns of a small m x m matrix
+void keep_submatrix(std::vector<double>& G, size_t m, const std::vector<size_t>& keep) {
+    std::vector<double> result(keep.size() * keep.size());
+    for (size_t a = 0; a < keep.size(); ++a) {
+        for (size_t c = 0; c < keep.size(); ++c) {
+            result[a * keep.size() + c] = G[keep[a] * m + keep[c]];
+        }
+    }
+    G.swap(result);
+}
+
+} // namespace
+
+bool BlockSolveReport::converged() const {
+    for (size_t j = 0; j < reasons.size(); ++j) {
+        if (reasons[j] != ConvergenceReason::Converged) return false;
+    }
+    return true;
+}
+
+BlockSolveReport solve_block_cg(const LinearOperator& A, const MultiVector& B, MultiVector& X,
+                                size_t max_iter, double tolerance) {
+    if (A.rows() != B.rows() || A.cols() != X.rows() || B.cols() != X.cols()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Block CG requires a square matrix");
+    }
+
+    Clock::time_point begin = Clock::now();
+    const size_t n = A.rows();
+    const size_t k = B.cols();
+
+    BlockSolveReport report;
+    report.column_iterations.assign(k, 0);
+    report.reasons.assign(k, ConvergenceReason::MaxIterations);
+    report.final_residuals.assign(k, 0.0);
+
+    // ||b_j|| for the relative tolerance of each column
+    std::vector<double> b_norms(k, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        const double* b = B.row(i);
+        for (size_t j = 0; j < k; ++j) b_norms[j] += b[j] * b[j];
+    }
+    for (size_t j = 0; j < k; ++j) b_norms[j] = std::sqrt(b_norms[j]);
+
+    // 1. Initialization: R = B - A X, P = R
+    MultiVector Xa = X;
+    MultiVector R(n, k);
+    Clock::time_point t = Clock::now();
+    A.multiplyBlock(X, R);
+    report.time_spmm += seconds_since(t);
+    t = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        const double* b = B.row(i);
+        double* r = R.row(i);
+        for (size_t j = 0; j < k; ++j) r[j] = b[j] - r[j];
+    }
+    MultiVector P = R;
+    MultiVector Q(n, k);
+    report.time_update += seconds_since(t);
+
+    t = Clock::now();
+    std::vector<double> RtR;
+    gram(R, R, RtR);
+    report.time_dot += seconds_since(t);
+
+    std::vector<size_t> active(k); // active column c solves right-hand side active[c]
+    for (size_t j = 0; j < k; ++j) active[j] = j;
+    std::vector<size_t> fallback;
+
+    std::vector<double> PtQ, L, alpha, beta, RtR_new;
+    std::vector<double> partial;
+    size_t it = 0;
+
+    // Drops active column c from the block (written back to X) and restarts P = R
+    auto drop_and_restart = [&](size_t c) {
+        std::vector<size_t> keep;
+        for (size_t a = 0; a < active.size(); ++a) {
+            if (a == c) continue;
+            keep.push_back(a);
+        }
+        const size_t j = active[c];
+        for (size_t i = 0; i < n; ++i) X.row(i)[j] = Xa.row(i)[c];
+        report.column_iterations[j] = it;
+        fallback.push_back(j);
+
+        const size_t m = active.size();
+        keep_columns(Xa, keep);
+        keep_columns(R, keep);
+        keep_submatrix(RtR, m, keep);
+        P = R;
+        std::vector<size_t> new_active;
+        for (size_t a = 0; a < keep.size(); ++a) new_active.push_back(active[keep[a]]);
+        active.swap(new_active);
+    };
+
+    // 2. Iterative Loop
+    while (true) {
+        // a) Deflation: write back and remove every column that has converged
+        size_t m = active.size();
+        std::vector<size_t> keep;
+        for (size_t c = 0; c < m; ++c) {
+            const size_t j = active[c];
+            const double r_norm = std::sqrt(std::max(RtR[c * m + c], 0.0));
+            if (r_norm <= tolerance * b_norms[j]) {
+                for (size_t i = 0; i < n; ++i) X.row(i)[j] = Xa.row(i)[c];
+                report.reasons[j] = ConvergenceReason::Converged;
+                report.column_iterations[j] = it;
+                report.final_residuals[j] = r_norm;
+            } else {
+                keep.push_back(c);
+            }
+        }
+        if (keep.size() < m) {
+            t = Clock::now();
+            keep_columns(Xa, keep);
+            keep_columns(R, keep);
+            keep_columns(P, keep);
+            keep_submatrix(RtR, m, keep);
+            std::vector<size_t> new_active;
+            for (size_t a = 0; a < keep.size(); ++a) new_active.push_back(active[keep[a]]);
+            active.swap(new_active);
+            m = active.size();
+            report.time_update += seconds_since(t);
+        }
+        if (m == 0 || it >= max_iter) {
+            break;
+        }
+
+        // b) Q = A P: one block product for all active columns
+        t = Clock::now();
+        Q.resize(n, m);
+        A.multiplyBlock(P, Q);
+        report.time_spmm += seconds_since(t);
+
+        // c) alpha = (P^T Q)^-1 (R^T R); P^T Q = P^T A P is symmetric, so only
+        //    its upper triangle is accumulated
+        t = Clock::now();
+        gram(P, Q, PtQ);
+        report.time_dot += seconds_since(t);
+        t = Clock::now();
+        L = PtQ;
+        size_t failed = cholesky(L, m);
+        if (failed < m) {
+            // Directions became linearly dependent: take that column out of the block
+            drop_and_restart(failed);
+            report.time_update += seconds_since(t);
+            continue;
+        }
+        alpha = RtR;
+        cholesky_solve(L, m, alpha);
+
+        // d) X += P alpha, R -= Q alpha, and R^T R of the new R in the same pass
+        const size_t blocks = parallel_block_count(n * m);
+        partial.assign(blocks * m * m, 0.0);
+        const double* alpha_data = alpha.data();
+        parallel_blocks(n, blocks, [&](size_t row_begin, size_t row_end, size_t block) {
+            double* g = &partial[block * m * m];
+#define UPDATE_CALL(M) update_rows<M>(P, Q, Xa, R, alpha_data, row_begin, row_end, m, g)
+            BLOCK_CG_DISPATCH(m, UPDATE_CALL)
+#undef UPDATE_CALL
+        });
+        reduce_partials(partial, blocks, m, RtR_new);
+
+        // e) beta = (R_old^T R_old)^-1 (R_new^T R_new)
+        L = RtR;
+        failed = cholesky(L, m);
+        if (failed < m) {
+            RtR = RtR_new;
+            ++it;
+            drop_and_restart(failed);
+            report.time_update += seconds_since(t);
+            continue;
+        }
+        beta = RtR_new;
+        cholesky_solve(L, m, beta);
+
+        // f) P = R + P beta
+        const double* beta_data = beta.data();
+        parallel_blocks(n, blocks, [&](size_t row_begin, size_t row_end, size_t) {
+#define DIRECTION_CALL(M) direction_rows<M>(P, R, beta_data, row_begin, row_end, m)
+            BLOCK_CG_DISPATCH(m, DIRECTION_CALL)
+#undef DIRECTION_CALL
+        });
+        RtR.swap(RtR_new);
+        report.time_update += seconds_since(t);
+        ++it;
+    }
+
+    // 3. Columns still active ran out of iterations
+    for (size_t c = 0; c < active.size(); ++c) {
+        const size_t j = active[c];
+        for (size_t i = 0; i < n; ++i) X.row(i)[j] = Xa.row(i)[c];
+        report.column_iterations[j] = it;
+        report.final_residuals[j] = std::sqrt(std::max(RtR[c * active.size() + c], 0.0));
+    }
+    report.iterations = it;
+
+    // 4. Columns taken out for rank deficiency finish on their own
+    CGWorkspace ws;
+    for (size_t f = 0; f < fallback.size(); ++f) {
+        const size_t j = fallback[f];
+        Vector x = X.column(j);
+        Vector b = B.column(j);
+        SolveReport single = solve_cg(A, b, x, max_iter, tolerance, ws, nullptr);
+        X.setColumn(j, x);
+        report.column_iterations[j] += single.iterations;
+        report.reasons[j] = single.reason;
+        report.final_residuals[j] = single.final_residual;
+        report.time_spmm += single.time_spmv;
+        report.time_dot += single.time_dot;
+        report.time_update += single.time_update;
+    }
+    report.fallback_columns = fallback.size();
+    report.time_total = seconds_since(begin);
+    return report;
+}
@@ -0,0 +1,88 @@
+// in file: src/CGSolver.cpp
+#include "CGSolver.hpp"
+#include <stdexcept>
+#include <algorithm> // For std::equal, std::copy
+#include <utility>   // For std::move
+
+CGSolver::CGSolver(SparseMatrix A, const CGSolverOptions& options)
+    : m_A(std::move(A)), m_options(options), m_values_changed(false), m_x(m_A.rows()) {
+    if (m_A.rows() != m_A.cols()) {
+        throw std::invalid_argument("CGSolver requires a square matrix");
+    }
+    // Symbolic and first numeric setup of the preconditioner
+    switch (m_options.preconditioner) {
+        case PreconditionerType::None:
+            break;
+        case PreconditionerType::Jacobi:
+            m_M.reset(new JacobiPreconditioner(m_A));
+            break;
+        case PreconditionerType::SSOR:
+            m_M.reset(new SSORPreconditioner(m_A, m_options.ssor_omega));
+            break;
+        case PreconditionerType::IC0:
+            m_M.reset(new IC0Preconditioner(m_A));
+            break;
+    }
+}
+
+void CGSolver::setValue(size_t slot, double value) {
+    if (slot >= m_A.nnz()) {
+        throw std::out_of_range("Matrix slot out of bounds");
+    }
+    m_A.mutableValues()[slot] = value;
+    m_values_changed = true;
+}
+
+void CGSolver::addValue(size_t slot, double value) {
+    if (slot >= m_A.nnz()) {
+        throw std::out_of_range("Matrix slot out of bounds");
+    }
+    m_A.mutableValues()[slot] += value;
+    m_values_changed = true;
+}
+
+void CGSolver::zeroValues() {
+    parallel_fill(m_A.mutableValues(), m_A.nnz(), 0.0);
+    m_values_changed = true;
+}
+
+void CGSolver::setValues(const SparseMatrix& A) {
+    if (A.rows() != m_A.rows() || A.cols() != m_A.cols() || A.nnz() != m_A.nnz() ||
+        !std::equal(A.rowOffsets().begin(), A.rowOffsets().end(), m_A.rowOffsets().begin()) ||
+        !std::equal(A.colIndices().begin(), A.colIndices().end(), m_A.colIndices().begin())) {
+        throw std::invalid_argument("Matrix does not have the solver's sparsity pattern");
+    }
+    std::copy(A.values().begin(), A.values().end(), m_A.mutableValues());
+    m_values_changed = true;
+}
+
+double* CGSolver::values() {
+    m_values_changed = true;
+    return m_A.mutableValues();
+}
+
+void CGSolver::refresh() {
+    if (m_M) {
+        m_M->updateValues(m_A);
+    }
+    m_values_changed = false;
+}
+
+SolveReport CGSolver::solve(const Vector& b, Vector& x, SolveMonitor* monitor) {
+    if (m_values_changed) {
+        refresh();
+    }
+    if (m_M) {
+        return solve_pcg(m_A, b, x, *m_M, m_options.max_iter, m_options.tolerance, m_workspace, monitor);
+    }
+    return solve_cg(m_A, b, x, m_options.max_iter, m_options.tolerance, m_workspace, monitor);
+}
+
+const Vector& CGSolver::solve(const Vector& b) {
+    m_report = solve(b, m_x, nullptr);
+    return m_x;
+}
+
+void CGSolver::resetSolution() {
+    parallel_fill(m_x.data(), m_x.size(), 0.0);
+}
@@ -0,0 +1,229 @@
+// in file: src/Chebyshev.cpp
+#include "Chebyshev.hpp"
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm> // For std::min, std::max
+
+namespace {
+
+// Number of eigenvalues of the tridiagonal matrix below x (Sturm sequence:
+// the negative pivots of the LDL^T factorization of T - x I)
+size_t count_below(const std::vector<double>& diag, const std::vector<double>& off_diag, double x,
+                   double tiny) {
+    size_t count = 0;
+    double q = 1.0;
+    for (size_t i = 0; i < diag.size(); ++i) {
+        q = diag[i] - x - (i > 0 ? off_diag[i - 1] * off_diag[i - 1] / q : 0.0);
+        if (q == 0.0) {
+            q = -tiny;
+        }
+        if (q < 0.0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// The eigenvalue with 0-based index 'which' in ascending order, by bisection in [lo, hi]
+double bisect_eigenvalue(const std::vector<double>& diag, const std::vector<double>& off_diag,
+                         size_t which, double lo, double hi) {
+    const double eps = std::numeric_limits<double>::epsilon();
+    const double tiny = eps * std::max(std::fabs(lo), std::fabs(hi)) + std::numeric_limits<double>::min();
+    for (int it = 0; it < 200; ++it) {
+        const double mid = 0.5 * (lo + hi);
+        if (hi - lo <= 2.0 * eps * std::max(std::fabs(lo), std::fabs(hi)) || mid == lo || mid == hi) {
+            break;
+        }
+        if (count_below(diag, off_diag, mid, tiny) > which) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Deterministic start vector with entries in [-1, 1]
+Vector random_vector(size_t n) {
+    std::mt19937 generator(20240601u);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    Vector v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = uniform(generator);
+    }
+    return v;
+}
+
+} // namespace
+
+// --- Spectral bounds ---
+
+SpectrumEstimate tridiagonal_extreme_eigenvalues(const std::vector<double>& diag,
+                                                 const std::vector<double>& off_diag) {
+    const size_t k = diag.size();
+    if (k == 0) {
+        throw std::invalid_argument("Tridiagonal matrix is empty");
+    }
+    if (off_diag.size() + 1 != k) {
+        throw std::length_error("Off-diagonal must have one entry less than the diagonal");
+    }
+
+    // Gershgorin discs bound the spectrum
+    double lo = diag[0], hi = diag[0];
+    for (size_t i = 0; i < k; ++i) {
+        const double radius = (i > 0 ? std::fabs(off_diag[i - 1]) : 0.0) +
+                              (i + 1 < k ? std::fabs(off_diag[i]) : 0.0);
+        lo = std::min(lo, diag[i] - radius);
+        hi = std::max(hi, diag[i] + radius);
+    }
+
+    SpectrumEstimate estimate;
+    estimate.lambda_min = bisect_eigenvalue(diag, off_diag, 0, lo, hi);
+    estimate.lambda_max = bisect_eigenvalue(diag, off_diag, k - 1, lo, hi);
+    estimate.steps = k;
+    return estimate;
+}
+
+SpectrumEstimate spectrum_from_cg(const SolveReport& report) {
+    const std::vector<double>& alpha = report.cg_alpha;
+    const std::vector<double>& beta = report.cg_beta;
+    const size_t k = alpha.size();
+    if (k == 0 || beta.size() != k) {
+        throw std::invalid_argument("SolveReport has no CG coefficients");
+    }
+
+    // Lanczos tridiagonal T_k from the CG coefficients
+    std::vector<double> diag(k), off_diag(k - 1);
+    diag[0] = 1.0 / alpha[0];
+    for (size_t j = 1; j < k; ++j) {
+        diag[j] = 1.0 / alpha[j] + beta[j - 1] / alpha[j - 1];
+    }
+    for (size_t j = 0; j + 1 < k; ++j) {
+        off_diag[j] = std::sqrt(beta[j]) / alpha[j];
+    }
+    return tridiagonal_extreme_eigenvalues(diag, off_diag);
+}
+
+SpectrumEstimate estimate_spectrum(const LinearOperator& A, size_t steps, const Preconditioner* M) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Spectrum estimate requires a square operator");
+    }
+    const Vector b = random_vector(A.rows());
+    Vector x(A.rows());
+    CGWorkspace workspace;
+
+    // Tolerance 0: run all 'steps' iterations unless CG finishes exactly
+    SolveReport report = M ? solve_pcg(A, b, x, *M, steps, 0.0, workspace, nullptr)
+                           : solve_cg(A, b, x, steps, 0.0, workspace, nullptr);
+    if (report.cg_alpha.empty()) {
+        throw std::runtime_error("Lanczos estimate failed: no CG step completed (operator not SPD?)");
+    }
+    return spectrum_from_cg(report);
+}
+
+double estimate_lambda_max(const LinearOperator& A, size_t iterations, const Preconditioner* M) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Spectrum estimate requires a square operator");
+    }
+    const size_t n = A.rows();
+    Vector v = random_vector(n);
+    Vector w(n), z(n);
+    v.scale(1.0 / norm(v));
+
+    // v <- (M^-1) A v / ||(M^-1) A v||; with ||v|| = 1 the norm estimates |lambda_max|
+    double lambda = 0.0;
+    for (size_t it = 0; it < iterations; ++it) {
+        A.multiply(v, w);
+        if (M) {
+            M->apply(w, z);
+            w.copyFrom(z);
+        }
+        lambda = norm(w);
+        if (lambda == 0.0 || !std::isfinite(lambda)) {
+            break;
+        }
+        v.copyFrom(w);
+        v.scale(1.0 / lambda);
+    }
+    return lambda;
+}
+
+// --- ChebyshevPreconditioner ---
+
+ChebyshevPreconditioner::ChebyshevPreconditioner(const LinearOperator& A, const SpectrumEstimate& bounds,
+                                                 size_t degree, const Preconditioner* inner, double safety)
+    : m_A(A), m_inner(inner), m_degree(degree), m_safety(safety), m_lambda_min(0.0), m_lambda_max(0.0),
+      m_residual(A.rows()), m_direction(A.rows()), m_work(A.rows()) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Chebyshev preconditioner requires a square operator");
+    }
+    if (!(safety >= 1.0)) {
+        throw std::invalid_argument("Chebyshev safety factor must be at least 1");
+    }
+    setBounds(bounds);
+}
+
+void ChebyshevPreconditioner::setBounds(const SpectrumEstimate& bounds) {
+    const double lambda_max = bounds.lambda_max * m_safety;
+    if (!(bounds.lambda_min > 0.0) || !(bounds.lambda_min < lambda_max) || !std::isfinite(lambda_max)) {
+        throw std::invalid_argument("Chebyshev bounds must satisfy 0 < lambda_min < lambda_max");
+    }
+    m_lambda_min = bounds.lambda_min;
+    m_lambda_max = lambda_max;
+}
+
+void ChebyshevPreconditioner::updateValues(const SparseMatrix& A) {
+    if (static_cast<const LinearOperator*>(&A) != &m_A) {
+        throw std::invalid_argument("Chebyshev preconditioner must be updated with the matrix it references");
+    }
+}
+
+// Chebyshev iteration for A z = r from z = 0 (Saad, "Iterative Methods for
+// Sparse Linear Systems", Alg. 12.1). The step coefficients depend only on
+// the bounds, so there are no inner products.
+void ChebyshevPreconditioner::apply(const Vector& r, Vector& z) const {
+    const size_t n = m_A.rows();
+    if (r.size() != n || z.size() != n) {
+        throw std::length_error("Preconditioner size does not match the vectors.");
+    }
+
+    const double theta = 0.5 * (m_lambda_max + m_lambda_min); // centre of the interval
+    const double delta = 0.5 * (m_lambda_max - m_lambda_min); // half width
+    const double sigma = theta / delta;
+
+    Vector& res = m_residual;
+    Vector& d = m_direction;
+
+    // Step 0: d = M^-1 r / theta, z = d
+    res.copyFrom(r);
+    if (m_inner) {
+        m_inner->apply(res, m_work);
+        d.copyFrom(m_work);
+    } else {
+        d.copyFrom(res);
+    }
+    d.scale(1.0 / theta);
+    z.copyFrom(d);
+
+    // Steps 1 .. degree: one product with A each
+    double rho = 1.0 / sigma;
+    for (size_t k = 0; k < m_degree; ++k) {
+        // res = r - A z
+        m_A.multiply(d, m_work);
+        res.axpy(-1.0, m_work);
+
+        // d = rho_new * rho * d + (2 rho_new / delta) M^-1 res
+        const double rho_new = 1.0 / (2.0 * sigma - rho);
+        d.scale(rho_new * rho);
+        if (m_inner) {
+            m_inner->apply(res, m_work);
+            d.axpy(2.0 * rho_new / delta, m_work);
+        } else {
+            d.axpy(2.0 * rho_new / delta, res);
+        }
+        z.axpy(1.0, d);
+        rho = rho_new;
+    }
+}
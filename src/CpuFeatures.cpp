@@ -0,0 +1,18 @@
+// in file: src/CpuFeatures.cpp
+#include "CpuFeatures.hpp"
+
+bool cpu_has_avx2() {
+#if CFD_X86_DISPATCH
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_avx512f() {
+#if CFD_X86_DISPATCH
+    return __builtin_cpu_supports("avx512f") != 0;
+#else
+    return false;
+#endif
+}
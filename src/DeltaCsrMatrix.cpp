@@ -0,0 +1,289 @@
+// in file: src/DeltaCsrMatrix.cpp
+#include "DeltaCsrMatrix.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <cstring>   // For std::memcpy
+#include <algorithm> // For std::min, std::lower_bound
+
+#if CFD_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+const size_t DeltaCsrMatrix::kBlockRows;
+
+namespace {
+
+const size_t R = DeltaCsrMatrix::kBlockRows;
+
+// Everything a block kernel needs, gathered in one place
+struct DeltaView {
+    const DeltaCsrMatrix::Block* blocks;
+    const size_t* row_base;
+    const uint32_t* row_start;
+    const uint8_t* deltas;
+    const double* values;
+    size_t num_rows;
+};
+
+// Portable kernel for block b with delta type D.
+// Each row is summed in 4 interleaved partial sums, combined as
+// (s0 + s2) + (s1 + s3), then the remaining 0-3 terms in order:
+// exactly what the AVX2 kernel computes.
+template <class D>
+void delta_block_scalar(const DeltaView& A, size_t b, const double* x, double* y) {
+    const DeltaCsrMatrix::Block& block = A.blocks[b];
+    const D* d = reinterpret_cast<const D*>(A.deltas + block.delta_begin);
+    const double* v = A.values + block.nnz_begin;
+    const uint32_t* start = A.row_start + b * (R + 1);
+    const size_t row_begin = b * R;
+    const size_t row_count = std::min(R, A.num_rows - row_begin);
+
+    for (size_t r = 0; r < row_count; ++r) {
+        const size_t end = start[r + 1];
+        const double* xb = x + A.row_base[row_begin + r];
+        size_t k = start[r];
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        for (; k + 4 <= end; k += 4) {
+            s0 += v[k] * xb[d[k]];
+            s1 += v[k + 1] * xb[d[k + 1]];
+            s2 += v[k + 2] * xb[d[k + 2]];
+            s3 += v[k + 3] * xb[d[k + 3]];
+        }
+        double sum = (s0 + s2) + (s1 + s3);
+        for (; k < end; ++k) {
+            sum += v[k] * xb[d[k]];
+        }
+        y[row_begin + r] = sum;
+    }
+}
+
+#if CFD_X86_DISPATCH
+// Four deltas widened to 32-bit gather indices
+__attribute__((target("avx2")))
+inline __m128i load_deltas(const uint8_t* d) {
+    int32_t packed;
+    std::memcpy(&packed, d, sizeof(packed));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+}
+
+__attribute__((target("avx2")))
+inline __m128i load_deltas(const uint16_t* d) {
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(d)));
+}
+
+__attribute__((target("avx2")))
+inline __m128i load_deltas(const uint32_t* d) {
+    // 4-byte deltas are < 2^31, so they are valid signed gather indices
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+}
+
+// AVX2: 4 non-zeros per step, x gathered from base + delta.
+// A separate multiply and add (no FMA) keeps the rounding identical to the scalar kernel.
+template <class D>
+__attribute__((target("avx2")))
+void delta_block_avx2(const DeltaView& A, size_t b, const double* x, double* y) {
+    const DeltaCsrMatrix::Block& block = A.blocks[b];
+    const D* d = reinterpret_cast<const D*>(A.deltas + block.delta_begin);
+    const double* v = A.values + block.nnz_begin;
+    const uint32_t* start = A.row_start + b * (R + 1);
+    const size_t row_begin = b * R;
+    const size_t row_count = std::min(R, A.num_rows - row_begin);
+
+    for (size_t r = 0; r < row_count; ++r) {
+        const size_t end = start[r + 1];
+        const double* xb = x + A.row_base[row_begin + r];
+        size_t k = start[r];
+        __m256d acc = _mm256_setzero_pd();
+        for (; k + 4 <= end; k += 4) {
+            __m256d xv = _mm256_i32gather_pd(xb, load_deltas(d + k), 8);
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(v + k), xv));
+        }
+        // [s0 + s2, s1 + s3], then their sum
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        double sum = _mm_cvtsd_f64(half) + _mm_cvtsd_f64(_mm_unpackhi_pd(half, half));
+        for (; k < end; ++k) {
+            sum += v[k] * xb[d[k]];
+        }
+        y[row_begin + r] = sum;
+    }
+}
+#endif
+
+void delta_blocks(DeltaCsrMatrix::Kernel kernel, const DeltaView& A,
+                  size_t block_begin, size_t block_end, const double* x, double* y) {
+    for (size_t b = block_begin; b < block_end; ++b) {
+        const size_t width = A.blocks[b].delta_bytes;
+#if CFD_X86_DISPATCH
+        if (kernel == DeltaCsrMatrix::AVX2) {
+            if (width == 1) { delta_block_avx2<uint8_t>(A, b, x, y); continue; }
+            if (width == 2) { delta_block_avx2<uint16_t>(A, b, x, y); continue; }
+            if (width == 4) { delta_block_avx2<uint32_t>(A, b, x, y); continue; }
+        }
+#else
+        (void)kernel;
+#endif
+        switch (width) {
+            case 1: delta_block_scalar<uint8_t>(A, b, x, y); break;
+            case 2: delta_block_scalar<uint16_t>(A, b, x, y); break;
+            case 4: delta_block_scalar<uint32_t>(A, b, x, y); break;
+            default: delta_block_scalar<uint64_t>(A, b, x, y); break;
+        }
+    }
+}
+
+// Appends value as a 'bytes'-wide unsigned integer
+void append_delta(std::vector<uint8_t>& out, size_t value, size_t bytes) {
+    const size_t pos = out.size();
+    out.resize(pos + bytes);
+    if (bytes == 1) {
+        out[pos] = static_cast<uint8_t>(value);
+    } else if (bytes == 2) {
+        uint16_t v = static_cast<uint16_t>(value);
+        std::memcpy(&out[pos], &v, sizeof(v));
+    } else if (bytes == 4) {
+        uint32_t v = static_cast<uint32_t>(value);
+        std::memcpy(&out[pos], &v, sizeof(v));
+    } else {
+        uint64_t v = static_cast<uint64_t>(value);
+        std::memcpy(&out[pos], &v, sizeof(v));
+    }
+}
+
+} // namespace
+
+// Encoding: one pass per block to find the widest delta, one to write them
+DeltaCsrMatrix::DeltaCsrMatrix(const SparseMatrix& A)
+    : m_num_rows(A.rows()), m_num_cols(A.cols()), m_kernel(Scalar) {
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+    const size_t n = m_num_rows;
+    const size_t num_blocks = (n + R - 1) / R;
+
+    m_row_base.assign(n, 0);
+    m_row_start.assign(num_blocks * (R + 1), 0);
+    m_blocks.resize(num_blocks + 1);
+
+    for (size_t b = 0; b < num_blocks; ++b) {
+        const size_t row_begin = b * R;
+        const size_t row_end = std::min(n, row_begin + R);
+        const size_t nnz_begin = row_offsets[row_begin];
+        if (row_offsets[row_end] - nnz_begin > 0xFFFFFFFFu) {
+            throw std::overflow_error("DeltaCsrMatrix block has more than 2^32 non-zeros");
+        }
+
+        size_t max_delta = 0;
+        for (size_t i = row_begin; i < row_end; ++i) {
+            const size_t k_begin = row_offsets[i];
+            const size_t k_end = row_offsets[i + 1];
+            m_row_start[b * (R + 1) + (i - row_begin)] = static_cast<uint32_t>(k_begin - nnz_begin);
+            if (k_begin == k_end) {
+                continue;
+            }
+            // Every delta is taken from the row's first column, so each row must be sorted
+            for (size_t k = k_begin + 1; k < k_end; ++k) {
+                if (col_indices[k] < col_indices[k - 1]) {
+                    throw std::invalid_argument("DeltaCsrMatrix requires sorted column indices");
+                }
+            }
+            m_row_base[i] = col_indices[k_begin];
+            max_delta = std::max(max_delta, col_indices[k_end - 1] - col_indices[k_begin]);
+        }
+        m_row_start[b * (R + 1) + (row_end - row_begin)] =
+            static_cast<uint32_t>(row_offsets[row_end] - nnz_begin);
+
+        size_t bytes = 8;
+        if (max_delta < 0x100u) bytes = 1;
+        else if (max_delta < 0x10000u) bytes = 2;
+        else if (max_delta < 0x80000000u) bytes = 4;
+
+        // Align the block's deltas to their width
+        while (m_deltas.size() % bytes != 0) m_deltas.push_back(0);
+        m_blocks[b].nnz_begin = nnz_begin;
+        m_blocks[b].delta_begin = m_deltas.size();
+        m_blocks[b].delta_bytes = bytes;
+        for (size_t i = row_begin; i < row_end; ++i) {
+            for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+                append_delta(m_deltas, col_indices[k] - m_row_base[i], bytes);
+            }
+        }
+    }
+    // Sentinel: end of the last block
+    m_blocks[num_blocks].nnz_begin = A.nnz();
+    m_blocks[num_blocks].delta_begin = m_deltas.size();
+    m_blocks[num_blocks].delta_bytes = 1;
+
+    m_values.assign(A.values().begin(), A.values().end());
+
+    if (cpu_has_avx2()) {
+        m_kernel = AVX2;
+    }
+}
+
+void DeltaCsrMatrix::setKernel(Kernel kernel) {
+    if (kernel == AVX2 && !cpu_has_avx2()) {
+        throw std::runtime_error("Requested SpMV kernel is not supported by this CPU");
+    }
+    m_kernel = kernel;
+}
+
+void DeltaCsrMatrix::multiply(const Vector& x, Vector& y) const {
+    if (x.size() != m_num_cols) {
+        throw std::length_error("Matrix column count must match Vector size");
+    }
+    if (y.size() != m_num_rows) {
+        throw std::length_error("Result Vector size must match Matrix row count");
+    }
+
+    DeltaView view;
+    view.blocks = m_blocks.data();
+    view.row_base = m_row_base.data();
+    view.row_start = m_row_start.data();
+    view.deltas = m_deltas.data();
+    view.values = m_values.data();
+    view.num_rows = m_num_rows;
+
+    const size_t num_blocks = m_blocks.size() - 1;
+    const double* px = x.data();
+    double* py = y.data();
+
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || nnz() < kParallelMinWork) {
+        delta_blocks(m_kernel, view, 0, num_blocks, px, py);
+        return;
+    }
+
+    // Blocks split so that each thread gets ~nnz / num_threads non-zeros
+    const Kernel kernel = m_kernel;
+    const size_t total = nnz();
+    auto block_bound = [&](size_t p, size_t parts) -> size_t {
+        if (p >= parts) return num_blocks;
+        const size_t target = static_cast<size_t>((static_cast<double>(total) * p) / parts);
+        const Block* first = m_blocks.data();
+        const Block* found = std::lower_bound(first, first + num_blocks, target,
+            [](const Block& block, size_t value) { return block.nnz_begin < value; });
+        return static_cast<size_t>(found - first);
+    };
+    pool.run([&](size_t tid, size_t num_threads) {
+        delta_blocks(kernel, view, block_bound(tid, num_threads), block_bound(tid + 1, num_threads), px, py);
+    });
+}
+
+Vector DeltaCsrMatrix::operator*(const Vector& x) const {
+    Vector result(m_num_rows);
+    multiply(x, result);
+    return result;
+}
+
+size_t DeltaCsrMatrix::indexBytes() const {
+    return m_blocks.size() * sizeof(Block) + m_row_base.size() * sizeof(size_t) +
+           m_row_start.size() * sizeof(uint32_t) + m_deltas.size();
+}
+
+size_t DeltaCsrMatrix::blocksWithDeltaBytes(size_t bytes) const {
+    size_t count = 0;
+    for (size_t b = 0; b + 1 < m_blocks.size(); ++b) {
+        if (m_blocks[b].delta_bytes == bytes) ++count;
+    }
+    return count;
+}
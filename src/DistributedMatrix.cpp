@@ -0,0 +1,401 @@
+// in file: src/DistributedMatrix.cpp
+#include "DistributedMatrix.hpp"
+#include "Timing.hpp"
+#include <stdexcept>
+#include <string>
+#include <algorithm> // For std::sort, std::unique, std::lower_bound
+#include <climits>   // For INT_MAX
+#include <cmath>
+
+namespace {
+
+const int kHaloTag = 7001;
+const int kReduceTag = 7002;
+
+int comm_rank(MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    return rank;
+}
+
+int comm_size(MPI_Comm comm) {
+    int size = 1;
+    MPI_Comm_size(comm, &size);
+    return size;
+}
+
+// MPI counts are ints
+int to_count(size_t n) {
+    if (n > static_cast<size_t>(INT_MAX)) {
+        throw std::length_error("Message too large for an MPI count");
+    }
+    return static_cast<int>(n);
+}
+
+// Combines one running sum per rank into the global sum, on every rank.
+// local_sum(start) continues the sum from 'start' over this rank's entries
+// and is called exactly once.
+template <class LocalSum>
+double global_sum(MPI_Comm comm, DistributedReduction mode, LocalSum local_sum) {
+    if (mode == DistributedReduction::Allreduce) {
+        double local = local_sum(0.0);
+        double global = 0.0;
+        MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, comm);
+        return global;
+    }
+
+    // Ordered: rank 0 starts the sum, each rank continues it, the last one broadcasts
+    const int rank = comm_rank(comm);
+    const int size = comm_size(comm);
+    double sum = 0.0;
+    if (rank > 0) {
+        MPI_Recv(&sum, 1, MPI_DOUBLE, rank - 1, kReduceTag, comm, MPI_STATUS_IGNORE);
+    }
+    sum = local_sum(sum);
+    if (rank + 1 < size) {
+        MPI_Send(&sum, 1, MPI_DOUBLE, rank + 1, kReduceTag, comm);
+    }
+    MPI_Bcast(&sum, 1, MPI_DOUBLE, size - 1, comm);
+    return sum;
+}
+
+void check_same_layout(const DistributedVector& a, const DistributedVector& b) {
+    if (a.globalSize() != b.globalSize() || a.rowBegin() != b.rowBegin() || a.localSize() != b.localSize()) {
+        throw std::length_error("Distributed vectors must have the same distribution.");
+    }
+}
+
+// y += alpha * x on the local entries, continuing the running sum of y . y
+double local_axpy_dot(double start, double alpha, const Vector& x, Vector& y) {
+    const double* px = x.data();
+    double* py = y.data();
+    const size_t n = y.size();
+    double dot = start;
+    for (size_t i = 0; i < n; ++i) {
+        double v = py[i] + alpha * px[i];
+        py[i] = v;
+        dot += v * v;
+    }
+    return dot;
+}
+
+} // namespace
+
+// --- DistributedVector ---
+
+DistributedVector::DistributedVector() : m_comm(MPI_COMM_NULL), m_begin(0) {}
+
+DistributedVector::DistributedVector(MPI_Comm comm, const std::vector<size_t>& global_offsets)
+    : m_comm(comm), m_offsets(global_offsets), m_begin(0) {
+    const int rank = comm_rank(comm);
+    if (m_offsets.size() != static_cast<size_t>(comm_size(comm)) + 1) {
+        throw std::invalid_argument("Distributed vector needs one offset per rank plus the total size");
+    }
+    m_begin = m_offsets[rank];
+    m_local.resize(m_offsets[rank + 1] - m_begin);
+}
+
+void DistributedVector::scatter(const Vector& global) {
+    if (global.size() != globalSize()) {
+        throw std::length_error("Global vector size does not match the distribution.");
+    }
+    const double* src = global.data() + m_begin;
+    std::copy(src, src + m_local.size(), m_local.data());
+}
+
+Vector DistributedVector::gather() const {
+    const size_t size = m_offsets.size() - 1;
+    std::vector<int> counts(size), displs(size);
+    for (size_t p = 0; p < size; ++p) {
+        counts[p] = to_count(m_offsets[p + 1] - m_offsets[p]);
+        displs[p] = to_count(m_offsets[p]);
+    }
+    Vector global(globalSize());
+    MPI_Allgatherv(m_local.data(), counts[comm_rank(m_comm)], MPI_DOUBLE,
+                   global.data(), counts.data(), displs.data(), MPI_DOUBLE, m_comm);
+    return global;
+}
+
+double dot_product(const DistributedVector& a, const DistributedVector& b, DistributedReduction mode) {
+    check_same_layout(a, b);
+    const double* pa = a.local().data();
+    const double* pb = b.local().data();
+    const size_t n = a.localSize();
+    return global_sum(a.comm(), mode, [&](double sum) {
+        for (size_t i = 0; i < n; ++i) {
+            sum += pa[i] * pb[i];
+        }
+        return sum;
+    });
+}
+
+double norm(const DistributedVector& a, DistributedReduction mode) {
+    return std::sqrt(dot_product(a, a, mode));
+}
+
+// --- DistributedMatrix ---
+
+DistributedMatrix::DistributedMatrix(MPI_Comm comm, const SparseMatrix& local_rows)
+    : m_comm(comm), m_begin(0), m_num_local(local_rows.rows()) {
+    const int rank = comm_rank(comm);
+    const int size = comm_size(comm);
+    const size_t n_global = local_rows.cols();
+
+    // 1. Row distribution: every rank's row count, in rank order
+    unsigned long long my_rows = m_num_local;
+    std::vector<unsigned long long> all_rows(size);
+    MPI_Allgather(&my_rows, 1, MPI_UNSIGNED_LONG_LONG, all_rows.data(), 1, MPI_UNSIGNED_LONG_LONG, comm);
+    m_offsets.assign(size + 1, 0);
+    for (int p = 0; p < size; ++p) {
+        m_offsets[p + 1] = m_offsets[p] + all_rows[p];
+    }
+    if (m_offsets.back() != n_global) {
+        throw std::invalid_argument("Distributed matrix must be square: row blocks do not add up to cols()");
+    }
+    m_begin = m_offsets[rank];
+    const size_t end = m_begin + m_num_local;
+
+    // 2. Ghost columns: referenced but owned elsewhere, sorted (so grouped by owner)
+    const IndexArray& row_offsets = local_rows.rowOffsets();
+    const IndexArray& cols = local_rows.colIndices();
+    const DoubleArray& values = local_rows.values();
+    for (size_t k = 0; k < cols.size(); ++k) {
+        if (cols[k] < m_begin || cols[k] >= end) {
+            m_ghost_global.push_back(cols[k]);
+        }
+    }
+    std::sort(m_ghost_global.begin(), m_ghost_global.end());
+    m_ghost_global.erase(std::unique(m_ghost_global.begin(), m_ghost_global.end()), m_ghost_global.end());
+
+    // 3. Receive side: which rank owns each run of ghosts
+    std::vector<int> need_counts(size, 0);
+    for (size_t g = 0; g < m_ghost_global.size(); ++g) {
+        const int owner = static_cast<int>(std::upper_bound(m_offsets.begin(), m_offsets.end(),
+                                                            m_ghost_global[g]) - m_offsets.begin()) - 1;
+        if (m_recv_ranks.empty() || m_recv_ranks.back() != owner) {
+            m_recv_ranks.push_back(owner);
+            m_recv_offsets.push_back(g);
+        }
+        ++need_counts[owner];
+    }
+    m_recv_offsets.push_back(m_ghost_global.size());
+
+    // 4. Send side: every owner learns which of its entries we need
+    std::vector<int> give_counts(size, 0);
+    MPI_Alltoall(need_counts.data(), 1, MPI_INT, give_counts.data(), 1, MPI_INT, comm);
+    std::vector<int> need_displs(size, 0), give_displs(size, 0);
+    for (int p = 1; p < size; ++p) {
+        need_displs[p] = need_displs[p - 1] + need_counts[p - 1];
+        give_displs[p] = give_displs[p - 1] + give_counts[p - 1];
+    }
+    std::vector<unsigned long long> needed(m_ghost_global.begin(), m_ghost_global.end());
+    std::vector<unsigned long long> requested(give_displs[size - 1] + give_counts[size - 1]);
+    MPI_Alltoallv(needed.data(), need_counts.data(), need_displs.data(), MPI_UNSIGNED_LONG_LONG,
+                  requested.data(), give_counts.data(), give_displs.data(), MPI_UNSIGNED_LONG_LONG, comm);
+    for (int p = 0; p < size; ++p) {
+        if (give_counts[p] == 0) continue;
+        m_send_ranks.push_back(p);
+        m_send_offsets.push_back(m_send_indices.size());
+        for (int k = 0; k < give_counts[p]; ++k) {
+            m_send_indices.push_back(static_cast<size_t>(requested[give_displs[p] + k]) - m_begin);
+        }
+    }
+    m_send_offsets.push_back(m_send_indices.size());
+
+    // 5. Local column numbers, and the interior / boundary split.
+    // Entries keep their order within each row.
+    m_interior.offsets.push_back(0);
+    m_boundary.offsets.push_back(0);
+    for (size_t i = 0; i < m_num_local; ++i) {
+        bool boundary = false;
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (cols[k] < m_begin || cols[k] >= end) {
+                boundary = true;
+                break;
+            }
+        }
+        RowBlock& block = boundary ? m_boundary : m_interior;
+        block.rows.push_back(i);
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            const size_t c = cols[k];
+            size_t local = c - m_begin;
+            if (c < m_begin || c >= end) {
+                local = m_num_local + (std::lower_bound(m_ghost_global.begin(), m_ghost_global.end(), c) -
+                                       m_ghost_global.begin());
+            }
+            block.cols.push_back(local);
+            block.values.push_back(values[k]);
+        }
+        block.offsets.push_back(block.cols.size());
+    }
+
+    m_ghosts.resize(m_ghost_global.size());
+    m_send_buffer.resize(m_send_indices.size());
+    m_requests.reserve(m_recv_ranks.size() + m_send_ranks.size());
+}
+
+DistributedMatrix DistributedMatrix::distribute(MPI_Comm comm, const SparseMatrix& global) {
+    if (global.rows() != global.cols()) {
+        throw std::invalid_argument("Distributed matrix must be square");
+    }
+    const int rank = comm_rank(comm);
+    const std::vector<size_t> bounds = global.rowPartition(comm_size(comm));
+    const size_t first = bounds[rank];
+    const size_t last = bounds[rank + 1];
+
+    const IndexArray& offsets = global.rowOffsets();
+    std::vector<size_t> row_offsets(last - first + 1);
+    for (size_t i = first; i <= last; ++i) {
+        row_offsets[i - first] = offsets[i] - offsets[first];
+    }
+    std::vector<size_t> cols(global.colIndices().begin() + offsets[first],
+                             global.colIndices().begin() + offsets[last]);
+    std::vector<double> values(global.values().begin() + offsets[first],
+                               global.values().begin() + offsets[last]);
+    SparseMatrix local(last - first, global.cols(), std::move(values), std::move(cols), std::move(row_offsets));
+    return DistributedMatrix(comm, local);
+}
+
+DistributedVector DistributedMatrix::createVector() const {
+    return DistributedVector(m_comm, m_offsets);
+}
+
+void DistributedMatrix::checkVector(const DistributedVector& v, const char* what) const {
+    if (v.globalSize() != globalRows() || v.rowBegin() != m_begin || v.localSize() != m_num_local) {
+        throw std::length_error(std::string(what) + " does not have the matrix's row distribution.");
+    }
+}
+
+void DistributedMatrix::multiply(const DistributedVector& x, DistributedVector& y) const {
+    checkVector(x, "Input vector");
+    checkVector(y, "Result vector");
+    const double* px = x.local().data();
+    double* py = y.local().data();
+
+    // 1. Post the halo exchange: receive our ghosts, send what the neighbours need
+    m_requests.clear();
+    for (size_t k = 0; k < m_recv_ranks.size(); ++k) {
+        MPI_Request request;
+        MPI_Irecv(m_ghosts.data() + m_recv_offsets[k], to_count(m_recv_offsets[k + 1] - m_recv_offsets[k]),
+                  MPI_DOUBLE, m_recv_ranks[k], kHaloTag, m_comm, &request);
+        m_requests.push_back(request);
+    }
+    for (size_t k = 0; k < m_send_ranks.size(); ++k) {
+        for (size_t s = m_send_offsets[k]; s < m_send_offsets[k + 1]; ++s) {
+            m_send_buffer[s] = px[m_send_indices[s]];
+        }
+        MPI_Request request;
+        MPI_Isend(m_send_buffer.data() + m_send_offsets[k], to_count(m_send_offsets[k + 1] - m_send_offsets[k]),
+                  MPI_DOUBLE, m_send_ranks[k], kHaloTag, m_comm, &request);
+        m_requests.push_back(request);
+    }
+
+    // 2. Interior rows while the messages are in flight
+    const size_t num_interior = m_interior.rows.size();
+    for (size_t r = 0; r < num_interior; ++r) {
+        double sum = 0.0;
+        for (size_t k = m_interior.offsets[r]; k < m_interior.offsets[r + 1]; ++k) {
+            sum += m_interior.values[k] * px[m_interior.cols[k]];
+        }
+        py[m_interior.rows[r]] = sum;
+    }
+
+    // 3. Boundary rows once the ghosts have arrived
+    if (!m_requests.empty()) {
+        MPI_Waitall(static_cast<int>(m_requests.size()), m_requests.data(), MPI_STATUSES_IGNORE);
+    }
+    const double* ghosts = m_ghosts.data();
+    const size_t num_boundary = m_boundary.rows.size();
+    for (size_t r = 0; r < num_boundary; ++r) {
+        double sum = 0.0;
+        for (size_t k = m_boundary.offsets[r]; k < m_boundary.offsets[r + 1]; ++k) {
+            const size_t c = m_boundary.cols[k];
+            sum += m_boundary.values[k] * (c < m_num_local ? px[c] : ghosts[c - m_num_local]);
+        }
+        py[m_boundary.rows[r]] = sum;
+    }
+}
+
+// --- Distributed CG ---
+// Step for step the classic conjugate_gradient of cfd.cpp; only the SpMV and
+// the dot products communicate.
+SolveReport solve_cg(const DistributedMatrix& A, const DistributedVector& b, DistributedVector& x,
+                     size_t max_iter, double tolerance, const DistributedCGOptions& options) {
+    if (b.globalSize() != A.globalRows() || b.rowBegin() != A.rowBegin() || b.localSize() != A.localRows()) {
+        throw std::length_error("Right-hand side does not have the matrix's row distribution.");
+    }
+    const DistributedReduction mode = options.reduction;
+    const Clock::time_point begin = Clock::now();
+    SolveReport report;
+
+    DistributedVector r = A.createVector();
+    DistributedVector p = A.createVector();
+    DistributedVector Ap = A.createVector();
+
+    // 1. r = b - A x, p = r
+    Clock::time_point c = Clock::now();
+    A.multiply(x, r);
+    report.time_spmv += seconds_since(c);
+    c = Clock::now();
+    r.local().xpay(b.local(), -1.0);
+    p.local().copyFrom(r.local());
+    report.time_update += seconds_since(c);
+
+    c = Clock::now();
+    double r_old_dot_r_old = dot_product(r, r, mode);
+    const double b_norm = norm(b, mode);
+    report.time_dot += seconds_since(c);
+    double r_norm = std::sqrt(r_old_dot_r_old);
+    report.residual_history.push_back(r_norm);
+
+    // 2. Iterative loop
+    size_t k = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    for (; k < max_iter; ++k) {
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
+        }
+
+        // a) Ap = A p (halo exchange inside)
+        c = Clock::now();
+        A.multiply(p, Ap);
+        report.time_spmv += seconds_since(c);
+
+        // b) alpha = (r . r) / (p . Ap)
+        c = Clock::now();
+        const double p_dot_Ap = dot_product(p, Ap, mode);
+        report.time_dot += seconds_since(c);
+        if (!(p_dot_Ap > 0.0) || !std::isfinite(p_dot_Ap)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        const double alpha = r_old_dot_r_old / p_dot_Ap;
+
+        // c) x += alpha p; r -= alpha Ap with the new r . r in the same pass
+        c = Clock::now();
+        x.local().axpy(alpha, p.local());
+        const double r_new_dot_r_new = global_sum(A.comm(), mode, [&](double start) {
+            return local_axpy_dot(start, -alpha, Ap.local(), r.local());
+        });
+        r_norm = std::sqrt(r_new_dot_r_new);
+
+        // d) p = r + beta p
+        const double beta = r_new_dot_r_new / r_old_dot_r_old;
+        p.local().xpay(r.local(), beta);
+        report.time_update += seconds_since(c);
+
+        r_old_dot_r_old = r_new_dot_r_new;
+        report.residual_history.push_back(r_norm);
+    }
+
+    if (reason == ConvergenceReason::MaxIterations && r_norm <= tolerance * b_norm) {
+        reason = ConvergenceReason::Converged;
+    }
+    report.iterations = k;
+    report.reason = reason;
+    report.initial_residual = report.residual_history.front();
+    report.final_residual = report.residual_history.back();
+    report.time_total = seconds_since(begin);
+    return report;
+}
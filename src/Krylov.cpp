@@ -0,0 +1,545 @@
+// in file: src/Krylov.cpp
+#include "Krylov.hpp"
+#include "ThreadPool.hpp"
+#include "Timing.hpp"
+#include <stdexcept>
+#include <cmath>
+#include <cstring>   // For std::memcpy
+#include <algorithm> // For std::min
+
+namespace {
+
+// Entries of w processed against every basis column before moving on,
+// so that w is read from memory once per sweep (4 KiB stays in L1)
+const size_t kSweepChunk = 512;
+
+// Multi-dot: out[j] = V_j . w for the k columns of V (column-major, n rows).
+// One sweep over w and the basis; per-thread sums are added in thread order.
+void multi_dot(const double* V, size_t n, size_t k, const double* w, double* out,
+               std::vector<double>& partial) {
+    const size_t num_threads = parallel_block_count(n);
+    partial.assign(num_threads * k, 0.0);
+    parallel_blocks(n, num_threads, [&](size_t begin, size_t end, size_t tid) {
+        double* sums = partial.data() + tid * k;
+        for (size_t i0 = begin; i0 < end; i0 += kSweepChunk) {
+            const size_t i1 = std::min(end, i0 + kSweepChunk);
+            size_t j = 0;
+            // Four columns at a time: each w[i] load feeds four independent sums
+            for (; j + 4 <= k; j += 4) {
+                const double* v0 = V + j * n;
+                const double* v1 = v0 + n;
+                const double* v2 = v1 + n;
+                const double* v3 = v2 + n;
+                double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                for (size_t i = i0; i < i1; ++i) {
+                    const double wi = w[i];
+                    s0 += v0[i] * wi;
+                    s1 += v1[i] * wi;
+                    s2 += v2[i] * wi;
+                    s3 += v3[i] * wi;
+                }
+                sums[j] += s0;
+                sums[j + 1] += s1;
+                sums[j + 2] += s2;
+                sums[j + 3] += s3;
+            }
+            for (; j < k; ++j) {
+                const double* v = V + j * n;
+                double s = 0.0;
+                for (size_t i = i0; i < i1; ++i) {
+                    s += v[i] * w[i];
+                }
+                sums[j] += s;
+            }
+        }
+    });
+    for (size_t j = 0; j < k; ++j) {
+        double s = 0.0;
+        for (size_t t = 0; t < num_threads; ++t) {
+            s += partial[t * k + j];
+        }
+        out[j] = s;
+    }
+}
+
+// Multi-axpy: out += alpha * V c for the k columns of V, in one sweep over out
+void multi_axpy(double alpha, const double* V, size_t n, size_t k, const double* c, double* out) {
+    parallel_blocks(n, parallel_block_count(n), [&](size_t begin, size_t end, size_t) {
+        for (size_t i0 = begin; i0 < end; i0 += kSweepChunk) {
+            const size_t i1 = std::min(end, i0 + kSweepChunk);
+            size_t j = 0;
+            // Four columns at a time: one load and store of out[i] per four columns
+            for (; j + 4 <= k; j += 4) {
+                const double* v0 = V + j * n;
+                const double* v1 = v0 + n;
+                const double* v2 = v1 + n;
+                const double* v3 = v2 + n;
+                const double a0 = alpha * c[j];
+                const double a1 = alpha * c[j + 1];
+                const double a2 = alpha * c[j + 2];
+                const double a3 = alpha * c[j + 3];
+                for (size_t i = i0; i < i1; ++i) {
+                    out[i] += (a0 * v0[i] + a1 * v1[i]) + (a2 * v2[i] + a3 * v3[i]);
+                }
+            }
+            for (; j < k; ++j) {
+                const double* v = V + j * n;
+                const double a = alpha * c[j];
+                for (size_t i = i0; i < i1; ++i) {
+                    out[i] += a * v[i];
+                }
+            }
+        }
+    });
+}
+
+void check_sizes(const LinearOperator& A, const Vector& b, const Vector& x) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Krylov solvers require a square operator");
+    }
+    if (A.rows() != b.size() || A.cols() != x.size()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+}
+
+bool notify(SolveMonitor* monitor, size_t iteration, double r_norm, double b_norm, const Vector& x, const Vector& r) {
+    if (!monitor) {
+        return true;
+    }
+    IterationState state = { iteration, r_norm, b_norm > 0.0 ? r_norm / b_norm : r_norm, x, r };
+    return monitor->onIteration(state);
+}
+
+void finish(SolveReport& report, size_t iterations, ConvergenceReason reason, Clock::time_point begin) {
+    report.iterations = iterations;
+    report.reason = reason;
+    if (!report.residual_history.empty()) {
+        report.initial_residual = report.residual_history.front();
+        report.final_residual = report.residual_history.back();
+    }
+    report.time_total = seconds_since(begin);
+}
+
+// --- BiCGStab, right-preconditioned (M may be null) ---
+SolveReport bicgstab(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner* M,
+                     size_t max_iter, double tolerance, KrylovWorkspace& ws, SolveMonitor* monitor) {
+    check_sizes(A, b, x);
+    const Clock::time_point begin = Clock::now();
+    SolveReport report;
+
+    const size_t n = b.size();
+    Vector* vectors[] = { &ws.r, &ws.r_hat, &ws.p, &ws.v, &ws.s, &ws.t, &ws.p_hat, &ws.s_hat };
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); ++i) {
+        if (vectors[i]->size() != n) vectors[i]->resize(n);
+    }
+    Vector& r = ws.r;
+    Vector& r_hat = ws.r_hat;
+    Vector& p = ws.p;
+    Vector& v = ws.v;
+    Vector& s = ws.s;
+    Vector& t = ws.t;
+    // Without a preconditioner p_hat = p and s_hat = s
+    Vector& p_hat = M ? ws.p_hat : p;
+    Vector& s_hat = M ? ws.s_hat : s;
+
+    // r = b - A x, shadow residual r_hat = r
+    Clock::time_point c = Clock::now();
+    A.multiply(x, r);
+    report.time_spmv += seconds_since(c);
+    c = Clock::now();
+    r.xpay(b, -1.0);
+    r_hat.copyFrom(r);
+    report.time_update += seconds_since(c);
+    c = Clock::now();
+    double r_norm = norm(r);
+    const double b_norm = norm(b);
+    report.time_dot += seconds_since(c);
+    report.residual_history.push_back(r_norm);
+
+    // The recurrence for r drifts away from b - A x over many iterations, so
+    // convergence is confirmed with the true residual; if that is still too
+    // large the iteration restarts from it.
+    auto true_residual = [&]() {
+        Clock::time_point t0 = Clock::now();
+        A.multiply(x, r);
+        report.time_spmv += seconds_since(t0);
+        t0 = Clock::now();
+        r.xpay(b, -1.0);
+        report.time_update += seconds_since(t0);
+        t0 = Clock::now();
+        r_norm = norm(r);
+        report.time_dot += seconds_since(t0);
+        report.residual_history.back() = r_norm;
+        return r_norm <= tolerance * b_norm;
+    };
+
+    double rho = 1.0, alpha = 1.0, omega = 1.0;
+    bool restart = true;
+    size_t k = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    for (; k < max_iter; ++k) {
+        if (r_norm <= tolerance * b_norm) {
+            if (k == 0 || true_residual()) {
+                reason = ConvergenceReason::Converged;
+                break;
+            }
+            r_hat.copyFrom(r);
+            restart = true;
+        }
+
+        // a) rho = r_hat . r; p = r + beta (p - omega v)
+        c = Clock::now();
+        const double rho_new = dot_product(r_hat, r);
+        report.time_dot += seconds_since(c);
+        if (rho_new == 0.0 || !std::isfinite(rho_new)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        c = Clock::now();
+        if (restart) {
+            p.copyFrom(r);
+            restart = false;
+        } else {
+            const double beta = (rho_new / rho) * (alpha / omega);
+            p.axpy(-omega, v);
+            p.xpay(r, beta);
+        }
+        report.time_update += seconds_since(c);
+        rho = rho_new;
+
+        // b) v = A M^-1 p, alpha = rho / (r_hat . v)
+        if (M) {
+            c = Clock::now();
+            M->apply(p, p_hat);
+            report.time_preconditioner += seconds_since(c);
+        }
+        c = Clock::now();
+        A.multiply(p_hat, v);
+        report.time_spmv += seconds_since(c);
+        c = Clock::now();
+        const double r_hat_v = dot_product(r_hat, v);
+        report.time_dot += seconds_since(c);
+        if (r_hat_v == 0.0 || !std::isfinite(r_hat_v)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        alpha = rho / r_hat_v;
+
+        // c) s = r - alpha v; stop early if s is already small enough
+        c = Clock::now();
+        s.copyFrom(r);
+        const double s_norm = std::sqrt(s.axpyDot(-alpha, v));
+        report.time_update += seconds_since(c);
+        if (s_norm <= tolerance * b_norm) {
+            c = Clock::now();
+            x.axpy(alpha, p_hat);
+            r.copyFrom(s);
+            report.time_update += seconds_since(c);
+            r_norm = s_norm;
+            report.residual_history.push_back(r_norm);
+            if (!notify(monitor, k + 1, r_norm, b_norm, x, r)) {
+                reason = ConvergenceReason::StoppedByMonitor;
+                ++k;
+                break;
+            }
+            continue;
+        }
+
+        // d) t = A M^-1 s, omega = (t . s) / (t . t)
+        if (M) {
+            c = Clock::now();
+            M->apply(s, s_hat);
+            report.time_preconditioner += seconds_since(c);
+        }
+        c = Clock::now();
+        A.multiply(s_hat, t);
+        report.time_spmv += seconds_since(c);
+        c = Clock::now();
+        const double t_s = dot_product(t, s);
+        const double t_t = dot_product(t, t);
+        report.time_dot += seconds_since(c);
+        if (t_t == 0.0 || !std::isfinite(t_t)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        omega = t_s / t_t;
+
+        // e) x += alpha p_hat + omega s_hat, r = s - omega t
+        c = Clock::now();
+        x.axpy(alpha, p_hat);
+        x.axpy(omega, s_hat);
+        r.copyFrom(s);
+        r_norm = std::sqrt(r.axpyDot(-omega, t));
+        report.time_update += seconds_since(c);
+
+        report.residual_history.push_back(r_norm);
+        if (!notify(monitor, k + 1, r_norm, b_norm, x, r)) {
+            reason = ConvergenceReason::StoppedByMonitor;
+            ++k;
+            break;
+        }
+        if (omega == 0.0) {
+            ++k;
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+    }
+
+    if (reason == ConvergenceReason::MaxIterations && r_norm <= tolerance * b_norm && true_residual()) {
+        reason = ConvergenceReason::Converged;
+    }
+    finish(report, k, reason, begin);
+    return report;
+}
+
+// --- GMRES(m), right-preconditioned (M may be null) ---
+SolveReport gmres(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner* M,
+                  size_t max_iter, double tolerance, const GmresOptions& options,
+                  KrylovWorkspace& ws, SolveMonitor* monitor) {
+    check_sizes(A, b, x);
+    const Clock::time_point begin = Clock::now();
+    SolveReport report;
+
+    const size_t n = b.size();
+    const size_t m = gmres_restart_length(n, options);
+    const size_t ld = m + 1; // leading dimension of the Hessenberg matrix
+    if (ws.basis.size() != n * (m + 1)) ws.basis.resize(n * (m + 1));
+    if (ws.r.size() != n) ws.r.resize(n);
+    if (ws.w.size() != n) ws.w.resize(n);
+    if (ws.z.size() != n) ws.z.resize(n);
+    if (M && ws.t.size() != n) ws.t.resize(n);
+    ws.hessenberg.assign(ld * m, 0.0);
+    ws.cosines.assign(m, 0.0);
+    ws.sines.assign(m, 0.0);
+    ws.g.assign(m + 1, 0.0);
+    ws.h.assign(m + 1, 0.0);
+    ws.y.assign(m, 0.0);
+
+    double* V = ws.basis.data();
+    double* H = ws.hessenberg.data();
+    Vector& r = ws.r;
+    Vector& w = ws.w;
+    Vector& z = ws.z;
+    Vector& t = ws.t;
+
+    const double b_norm = norm(b);
+    double r_norm = 0.0;
+    size_t total = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    bool stopped = false;
+
+    while (true) {
+        // 1. True residual at the start of every cycle: r = b - A x
+        Clock::time_point c = Clock::now();
+        A.multiply(x, r);
+        report.time_spmv += seconds_since(c);
+        c = Clock::now();
+        r.xpay(b, -1.0);
+        report.time_update += seconds_since(c);
+        c = Clock::now();
+        r_norm = norm(r);
+        report.time_dot += seconds_since(c);
+        // It replaces the Arnoldi estimate of the previous cycle's last iteration
+        if (report.residual_history.empty()) {
+            report.residual_history.push_back(r_norm);
+        } else {
+            report.residual_history.back() = r_norm;
+        }
+
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
+        }
+        if (!std::isfinite(r_norm)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        if (stopped || total >= max_iter) {
+            break;
+        }
+
+        // 2. v_0 = r / ||r||, g = ||r|| e_1
+        c = Clock::now();
+        const double inv = 1.0 / r_norm;
+        const double* pr = r.data();
+        for (size_t i = 0; i < n; ++i) V[i] = pr[i] * inv;
+        report.time_update += seconds_since(c);
+        std::fill(ws.g.begin(), ws.g.end(), 0.0);
+        ws.g[0] = r_norm;
+
+        // 3. Arnoldi: j = number of basis vectors used by this cycle's update
+        size_t j = 0;
+        bool singular = false;
+        while (j < m && total < max_iter) {
+            // a) w = A M^-1 v_j
+            c = Clock::now();
+            std::memcpy(z.data(), V + j * n, n * sizeof(double));
+            report.time_update += seconds_since(c);
+            if (M) {
+                c = Clock::now();
+                M->apply(z, t);
+                report.time_preconditioner += seconds_since(c);
+            }
+            c = Clock::now();
+            A.multiply(M ? t : z, w);
+            report.time_spmv += seconds_since(c);
+
+            // b) CGS2: two passes of h = V^T w, w -= V h
+            double* h = ws.h.data();
+            c = Clock::now();
+            multi_dot(V, n, j + 1, w.data(), h, ws.partial);
+            report.time_dot += seconds_since(c);
+            c = Clock::now();
+            multi_axpy(-1.0, V, n, j + 1, h, w.data());
+            report.time_update += seconds_since(c);
+            double* hc = H + j * ld;
+            c = Clock::now();
+            multi_dot(V, n, j + 1, w.data(), hc, ws.partial);
+            report.time_dot += seconds_since(c);
+            c = Clock::now();
+            multi_axpy(-1.0, V, n, j + 1, hc, w.data());
+            report.time_update += seconds_since(c);
+            for (size_t i = 0; i <= j; ++i) hc[i] += h[i];
+            c = Clock::now();
+            const double h_next = norm(w);
+            report.time_dot += seconds_since(c);
+            hc[j + 1] = h_next;
+
+            // c) v_{j+1} = w / h_{j+1,j} (h_{j+1,j} = 0: the solution lies in the current space)
+            if (h_next > 0.0) {
+                c = Clock::now();
+                const double scale = 1.0 / h_next;
+                const double* pw = w.data();
+                double* v_next = V + (j + 1) * n;
+                for (size_t i = 0; i < n; ++i) v_next[i] = pw[i] * scale;
+                report.time_update += seconds_since(c);
+            }
+
+            // d) Givens rotations keep H upper triangular; |g_{j+1}| is the residual norm
+            double* cs = ws.cosines.data();
+            double* sn = ws.sines.data();
+            for (size_t i = 0; i < j; ++i) {
+                const double a = hc[i];
+                const double d = hc[i + 1];
+                hc[i] = cs[i] * a + sn[i] * d;
+                hc[i + 1] = -sn[i] * a + cs[i] * d;
+            }
+            const double denom = std::hypot(hc[j], hc[j + 1]);
+            if (!(denom > 0.0) || !std::isfinite(denom)) {
+                singular = true;
+                break;
+            }
+            cs[j] = hc[j] / denom;
+            sn[j] = hc[j + 1] / denom;
+            hc[j] = denom;
+            hc[j + 1] = 0.0;
+            ws.g[j + 1] = -sn[j] * ws.g[j];
+            ws.g[j] = cs[j] * ws.g[j];
+
+            ++j;
+            ++total;
+            const double estimate = std::fabs(ws.g[j]);
+            report.residual_history.push_back(estimate);
+            if (!notify(monitor, total, estimate, b_norm, x, r)) {
+                stopped = true;
+                break;
+            }
+            if (estimate <= tolerance * b_norm || h_next == 0.0) {
+                break;
+            }
+        }
+
+        // 4. x += M^-1 V_j y with R y = g (back substitution)
+        if (j > 0) {
+            c = Clock::now();
+            double* y = ws.y.data();
+            for (size_t i = j; i-- > 0; ) {
+                double s = ws.g[i];
+                for (size_t l = i + 1; l < j; ++l) {
+                    s -= H[l * ld + i] * y[l];
+                }
+                y[i] = s / H[i * ld + i];
+            }
+            parallel_fill(z.data(), n, 0.0);
+            multi_axpy(1.0, V, n, j, y, z.data());
+            report.time_update += seconds_since(c);
+            if (M) {
+                c = Clock::now();
+                M->apply(z, t);
+                report.time_preconditioner += seconds_since(c);
+            }
+            c = Clock::now();
+            x.axpy(1.0, M ? t : z);
+            report.time_update += seconds_since(c);
+        }
+        if (singular) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+    }
+
+    if (stopped && reason != ConvergenceReason::Converged) {
+        reason = ConvergenceReason::StoppedByMonitor;
+    }
+    finish(report, total, reason, begin);
+    return report;
+}
+
+} // namespace
+
+size_t gmres_restart_length(size_t n, const GmresOptions& options) {
+    if (options.restart == 0) {
+        throw std::invalid_argument("GMRES restart length must be at least 1");
+    }
+    size_t m = options.restart;
+    if (options.max_basis_bytes != 0 && n != 0) {
+        const size_t columns = options.max_basis_bytes / (n * sizeof(double));
+        if (columns < 2) {
+            throw std::length_error("GMRES basis memory cap is too small for two vectors");
+        }
+        m = std::min(m, columns - 1);
+    }
+    return m;
+}
+
+// --- BiCGStab entry points ---
+
+Vector solve_bicgstab(const LinearOperator& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance) {
+    Vector x = x0;
+    KrylovWorkspace workspace;
+    bicgstab(A, b, x, nullptr, max_iter, tolerance, workspace, nullptr);
+    return x;
+}
+
+SolveReport solve_bicgstab(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                           KrylovWorkspace& workspace, SolveMonitor* monitor) {
+    return bicgstab(A, b, x, nullptr, max_iter, tolerance, workspace, monitor);
+}
+
+SolveReport solve_bicgstab(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M,
+                           size_t max_iter, double tolerance, KrylovWorkspace& workspace, SolveMonitor* monitor) {
+    return bicgstab(A, b, x, &M, max_iter, tolerance, workspace, monitor);
+}
+
+// --- GMRES entry points ---
+
+Vector solve_gmres(const LinearOperator& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance,
+                   size_t restart) {
+    Vector x = x0;
+    KrylovWorkspace workspace;
+    GmresOptions options;
+    options.restart = restart;
+    gmres(A, b, x, nullptr, max_iter, tolerance, options, workspace, nullptr);
+    return x;
+}
+
+SolveReport solve_gmres(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                        const GmresOptions& options, KrylovWorkspace& workspace, SolveMonitor* monitor) {
+    return gmres(A, b, x, nullptr, max_iter, tolerance, options, workspace, monitor);
+}
+
+SolveReport solve_gmres(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M,
+                        size_t max_iter, double tolerance, const GmresOptions& options,
+                        KrylovWorkspace& workspace, SolveMonitor* monitor) {
+    return gmres(A, b, x, &M, max_iter, tolerance, options, workspace, monitor);
+}
@@ -0,0 +1,544 @@
+// in file: src/MatrixIO.cpp
+#include "MatrixIO.hpp"
+#include "SparseMatrixBuilder.hpp"
+#include "ThreadPool.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+// POSIX memory mapping
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// The binary format stores 64-bit indices and the kernels read them as size_t
+static_assert(sizeof(size_t) == sizeof(uint64_t), "binary CSR format requires a 64-bit size_t");
+
+namespace {
+
+// Text is read and parsed in blocks of this size
+const size_t kReadBlockBytes = size_t(64) << 20;
+
+// Rows per formatting block when writing (bounded by nnz, see below)
+const size_t kWriteBlockNnz = size_t(1) << 20;
+
+const char kBinaryMagic[8] = {'C', 'F', 'D', 'C', 'S', 'R', '0', '1'};
+const uint64_t kByteOrderMark = 0x0102030405060708ULL;
+
+// --- Matrix Market header ---
+
+struct MtxHeader {
+    bool coordinate;   // coordinate (sparse) or array (dense)
+    bool pattern;      // no values stored, every entry is 1
+    bool symmetric;    // only one triangle stored
+    bool skew;         // skew-symmetric: a_ji = -a_ij
+    size_t rows;
+    size_t cols;
+    size_t entries;
+};
+
+std::string to_lower(std::string s) {
+    for (size_t i = 0; i < s.size(); ++i) {
+        s[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(s[i])));
+    }
+    return s;
+}
+
+// Reads the banner, skips comments and reads the size line
+MtxHeader read_mtx_header(std::istream& in, const std::string& path) {
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error("Matrix Market file is empty: " + path);
+    }
+
+    std::istringstream banner(line);
+    std::string tag, object, format, field, symmetry;
+    banner >> tag >> object >> format >> field >> symmetry;
+    if (tag != "%%MatrixMarket" || to_lower(object) != "matrix") {
+        throw std::runtime_error("Not a Matrix Market matrix file: " + path);
+    }
+    format = to_lower(format);
+    field = to_lower(field);
+    symmetry = to_lower(symmetry);
+
+    MtxHeader h;
+    h.coordinate = format == "coordinate";
+    if (!h.coordinate && format != "array") {
+        throw std::runtime_error("Unknown Matrix Market format '" + format + "' in " + path);
+    }
+    if (field != "real" && field != "integer" && field != "double" && field != "pattern") {
+        throw std::runtime_error("Unsupported Matrix Market field '" + field + "' in " + path);
+    }
+    h.pattern = field == "pattern";
+    h.symmetric = symmetry == "symmetric";
+    h.skew = symmetry == "skew-symmetric";
+    if (symmetry != "general" && !h.symmetric && !h.skew) {
+        throw std::runtime_error("Unsupported Matrix Market symmetry '" + symmetry + "' in " + path);
+    }
+
+    // Skip comment lines, then read the size line
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] != '%') {
+            break;
+        }
+    }
+    std::istringstream sizes(line);
+    h.entries = 0;
+    if (h.coordinate) {
+        sizes >> h.rows >> h.cols >> h.entries;
+    } else {
+        sizes >> h.rows >> h.cols;
+        h.entries = h.rows * h.cols;
+    }
+    if (!sizes) {
+        throw std::runtime_error("Malformed Matrix Market size line in " + path);
+    }
+    return h;
+}
+
+// Parses the coordinate lines in text[begin, end) into one builder slot.
+// Returns the number of entries read. text must be NUL-terminated after end.
+size_t parse_coordinate_lines(const char* text, size_t begin, size_t end, const MtxHeader& h,
+                              SparseMatrixBuilder& builder, size_t slot) {
+    size_t count = 0;
+    const char* p = text + begin;
+    const char* stop = text + end;
+    while (p < stop) {
+        // Skip blank space and stray comment lines
+        while (p < stop && std::isspace(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        if (p >= stop) {
+            break;
+        }
+        if (*p == '%') {
+            while (p < stop && *p != '\n') {
+                ++p;
+            }
+            continue;
+        }
+
+        char* next = 0;
+        unsigned long long row = std::strtoull(p, &next, 10);
+        unsigned long long col = std::strtoull(next, &next, 10);
+        double value = 1.0;
+        if (!h.pattern) {
+            value = std::strtod(next, &next);
+        }
+        if (next == p || row == 0 || col == 0) {
+            throw std::runtime_error("Malformed Matrix Market entry");
+        }
+
+        // Matrix Market indices are 1-based
+        builder.addValue(row - 1, col - 1, value, slot);
+        if ((h.symmetric || h.skew) && row != col) {
+            builder.addValue(col - 1, row - 1, h.skew ? -value : value, slot);
+        }
+        ++count;
+
+        p = next;
+        while (p < stop && *p != '\n') {
+            ++p;
+        }
+    }
+    return count;
+}
+
+// Splits text[0, length) into one range per thread at line boundaries and parses them
+size_t parse_block(const std::vector<char>& text, size_t length, const MtxHeader& h,
+                   SparseMatrixBuilder& builder, size_t num_slots) {
+    std::vector<size_t> counts(num_slots, 0);
+    const char* data = text.data();
+
+    ThreadPool::global().run([&](size_t tid, size_t num_threads) {
+        // Thread tid parses the lines that START inside its share of the bytes
+        for (size_t part = tid; part < num_slots; part += num_threads) {
+            size_t begin = length * part / num_slots;
+            size_t end = length * (part + 1) / num_slots;
+            if (part > 0) {
+                while (begin < length && data[begin - 1] != '\n') {
+                    ++begin;
+                }
+            }
+            if (part + 1 < num_slots) {
+                while (end < length && data[end - 1] != '\n') {
+                    ++end;
+                }
+            }
+            if (begin < end) {
+                counts[part] += parse_coordinate_lines(data, begin, end, h, builder, part);
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (size_t t = 0; t < num_slots; ++t) {
+        total += counts[t];
+    }
+    return total;
+}
+
+size_t align64(size_t offset) {
+    return (offset + 63) / 64 * 64;
+}
+
+void check_binary_header(const BinaryCsrHeader& h, size_t file_size, const std::string& path) {
+    if (std::memcmp(h.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        throw std::runtime_error("Not a binary CSR file: " + path);
+    }
+    if (h.byte_order != kByteOrderMark) {
+        throw std::runtime_error("Binary CSR file was written with a different byte order: " + path);
+    }
+    if (h.row_offsets_offset % 64 != 0 || h.col_indices_offset % 64 != 0 || h.values_offset % 64 != 0) {
+        throw std::runtime_error("Binary CSR sections are not 64-byte aligned: " + path);
+    }
+    // Counts are compared with the 8-byte entries left after each section's
+    // offset, so huge header values cannot wrap around the size test
+    if (h.row_offsets_offset > file_size || h.col_indices_offset > file_size || h.values_offset > file_size ||
+        h.num_rows >= (file_size - h.row_offsets_offset) / sizeof(uint64_t) ||
+        h.nnz > (file_size - h.col_indices_offset) / sizeof(uint64_t) ||
+        h.nnz > (file_size - h.values_offset) / sizeof(double)) {
+        throw std::runtime_error("Binary CSR file is truncated: " + path);
+    }
+}
+
+// The row offsets of a binary CSR file must start at 0, never decrease and
+// end at nnz: the SpMV and the row-block copies index the arrays with them
+void check_binary_offsets(const BinaryCsrHeader& h, const size_t* row_offsets, const std::string& path) {
+    bool monotone = row_offsets[0] == 0 && row_offsets[h.num_rows] == h.nnz;
+    for (size_t i = 0; monotone && i < h.num_rows; ++i) {
+        monotone = row_offsets[i] <= row_offsets[i + 1];
+    }
+    if (!monotone) {
+        throw std::runtime_error("Binary CSR row offsets are inconsistent: " + path);
+    }
+}
+
+// Every column index must address an entry of x
+void check_binary_columns(const BinaryCsrHeader& h, const size_t* col_indices, const std::string& path) {
+    for (size_t k = 0; k < h.nnz; ++k) {
+        if (col_indices[k] >= h.num_cols) {
+            throw std::runtime_error("Binary CSR column index out of range: " + path);
+        }
+    }
+}
+
+} // namespace
+
+// --- Matrix Market Reading ---
+
+SparseMatrix read_matrix_market(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+    MtxHeader h = read_mtx_header(in, path);
+    if (!h.coordinate) {
+        throw std::runtime_error("Dense (array) Matrix Market files are read with read_matrix_market_vector: " + path);
+    }
+
+    const size_t num_slots = get_num_threads();
+    SparseMatrixBuilder builder(h.rows, h.cols, num_slots);
+    for (size_t s = 0; s < num_slots; ++s) {
+        builder.reserve((h.symmetric || h.skew ? 2 : 1) * h.entries / num_slots + 1, s);
+    }
+
+    // Stream the body: each block ends at its last newline, the rest is
+    // carried over to the front of the next block.
+    std::vector<char> block(kReadBlockBytes + 1);
+    size_t carry = 0;
+    size_t entries_read = 0;
+    while (true) {
+        in.read(block.data() + carry, static_cast<std::streamsize>(kReadBlockBytes - carry));
+        size_t length = carry + static_cast<size_t>(in.gcount());
+        bool last = !in;
+
+        size_t cut = length;
+        if (!last) {
+            while (cut > 0 && block[cut - 1] != '\n') {
+                --cut;
+            }
+            if (cut == 0) {
+                throw std::runtime_error("Matrix Market line longer than the read block in " + path);
+            }
+        }
+
+        char saved = block[cut];
+        block[cut] = '\0'; // strtod/strtoull must not run past the block
+        entries_read += parse_block(block, cut, h, builder, num_slots);
+        block[cut] = saved;
+
+        if (last) {
+            break;
+        }
+        carry = length - cut;
+        std::memmove(block.data(), block.data() + cut, carry);
+    }
+
+    if (entries_read != h.entries) {
+        std::ostringstream msg;
+        msg << "Matrix Market file " << path << " declares " << h.entries
+            << " entries but contains " << entries_read;
+        throw std::runtime_error(msg.str());
+    }
+    return builder.build();
+}
+
+// --- Matrix Market Writing ---
+
+void write_matrix_market(const std::string& path, const SparseMatrix& A) {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    out << "%%MatrixMarket matrix coordinate real general\n";
+    out << A.rows() << " " << A.cols() << " " << A.nnz() << "\n";
+
+    const IndexArray& offsets = A.rowOffsets();
+    const IndexArray& cols = A.colIndices();
+    const DoubleArray& vals = A.values();
+    ThreadPool& pool = ThreadPool::global();
+    std::vector<std::string> parts(pool.size());
+
+    // Format a block of rows in parallel (one string per thread), then write in order
+    size_t row = 0;
+    while (row < A.rows()) {
+        size_t block_end = row;
+        while (block_end < A.rows() && offsets[block_end] - offsets[row] < kWriteBlockNnz) {
+            ++block_end;
+        }
+        const size_t block_begin = row;
+
+        pool.run([&](size_t tid, size_t num_threads) {
+            for (size_t part = tid; part < parts.size(); part += num_threads) {
+                std::string& text = parts[part];
+                text.clear();
+                size_t first = block_begin + (block_end - block_begin) * part / parts.size();
+                size_t last = block_begin + (block_end - block_begin) * (part + 1) / parts.size();
+                char line[96];
+                for (size_t i = first; i < last; ++i) {
+                    for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                        int len = std::snprintf(line, sizeof(line), "%llu %llu %.17g\n",
+                                                static_cast<unsigned long long>(i + 1),
+                                                static_cast<unsigned long long>(cols[k] + 1), vals[k]);
+                        text.append(line, static_cast<size_t>(len));
+                    }
+                }
+            }
+        });
+
+        for (size_t t = 0; t < parts.size(); ++t) {
+            out.write(parts[t].data(), static_cast<std::streamsize>(parts[t].size()));
+        }
+        row = block_end;
+    }
+
+    if (!out) {
+        throw std::runtime_error("Error while writing " + path);
+    }
+}
+
+Vector read_matrix_market_vector(const std::string& path) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+    MtxHeader h = read_mtx_header(in, path);
+    if (h.cols != 1) {
+        throw std::runtime_error("Matrix Market vector must have exactly one column: " + path);
+    }
+
+    Vector v(h.rows);
+    for (size_t e = 0; e < h.entries; ++e) {
+        if (h.coordinate) {
+            size_t row = 0, col = 0;
+            double value = 1.0;
+            in >> row >> col;
+            if (!h.pattern) {
+                in >> value;
+            }
+            if (!in || row == 0 || row > h.rows) {
+                throw std::runtime_error("Malformed Matrix Market vector entry in " + path);
+            }
+            v[row - 1] += value;
+        } else {
+            in >> v[e];
+            if (!in) {
+                throw std::runtime_error("Matrix Market vector file is truncated: " + path);
+            }
+        }
+    }
+    return v;
+}
+
+void write_matrix_market_vector(const std::string& path, const Vector& v) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    out << "%%MatrixMarket matrix array real general\n";
+    out << v.size() << " 1\n";
+    char line[40];
+    for (size_t i = 0; i < v.size(); ++i) {
+        std::snprintf(line, sizeof(line), "%.17g\n", v[i]);
+        out << line;
+    }
+    if (!out) {
+        throw std::runtime_error("Error while writing " + path);
+    }
+}
+
+// --- Binary CSR ---
+
+void write_binary_csr(const std::string& path, const SparseMatrix& A) {
+    BinaryCsrHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    h.byte_order = kByteOrderMark;
+    h.num_rows = A.rows();
+    h.num_cols = A.cols();
+    h.nnz = A.nnz();
+    h.row_offsets_offset = align64(sizeof(BinaryCsrHeader));
+    h.col_indices_offset = align64(h.row_offsets_offset + (A.rows() + 1) * sizeof(uint64_t));
+    h.values_offset = align64(h.col_indices_offset + A.nnz() * sizeof(uint64_t));
+
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+
+    // Writes a section, preceded by zero padding up to its aligned offset
+    size_t position = 0;
+    const char zeros[64] = {0};
+    auto write_at = [&](size_t offset, const void* data, size_t bytes) {
+        out.write(zeros, static_cast<std::streamsize>(offset - position));
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        position = offset + bytes;
+    };
+    write_at(0, &h, sizeof(h));
+    write_at(h.row_offsets_offset, A.rowOffsets().data(), (A.rows() + 1) * sizeof(uint64_t));
+    write_at(h.col_indices_offset, A.colIndices().data(), A.nnz() * sizeof(uint64_t));
+    write_at(h.values_offset, A.values().data(), A.nnz() * sizeof(double));
+
+    if (!out) {
+        throw std::runtime_error("Error while writing " + path);
+    }
+}
+
+SparseMatrix read_binary_csr(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+    size_t file_size = static_cast<size_t>(in.tellg());
+    in.seekg(0);
+
+    BinaryCsrHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+        throw std::runtime_error("Binary CSR file is truncated: " + path);
+    }
+    check_binary_header(h, file_size, path);
+
+    IndexArray row_offsets(h.num_rows + 1);
+    in.seekg(static_cast<std::streamoff>(h.row_offsets_offset));
+    in.read(reinterpret_cast<char*>(row_offsets.data()), static_cast<std::streamsize>(row_offsets.size() * sizeof(size_t)));
+    if (!in) {
+        throw std::runtime_error("Error while reading " + path);
+    }
+    // The offsets decide where the row blocks below write, so check them first
+    check_binary_offsets(h, row_offsets.data(), path);
+
+    // Each pool thread first touches the rows it will multiply; the reads then fill them
+    IndexArray col_indices(h.nnz);
+    DoubleArray values(h.nnz);
+    csr_row_blocks(h.num_rows, row_offsets.data(), [&](size_t begin, size_t end) {
+        for (size_t k = row_offsets[begin]; k < row_offsets[end]; ++k) {
+            col_indices[k] = 0;
+            values[k] = 0.0;
+        }
+    });
+    in.seekg(static_cast<std::streamoff>(h.col_indices_offset));
+    in.read(reinterpret_cast<char*>(col_indices.data()), static_cast<std::streamsize>(col_indices.size() * sizeof(size_t)));
+    in.seekg(static_cast<std::streamoff>(h.values_offset));
+    in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+    if (!in) {
+        throw std::runtime_error("Error while reading " + path);
+    }
+    check_binary_columns(h, col_indices.data(), path);
+
+    return SparseMatrix(h.num_rows, h.num_cols,
+                        std::move(values), std::move(col_indices), std::move(row_offsets));
+}
+
+// --- Memory-mapped Binary CSR ---
+
+MappedSparseMatrix::MappedSparseMatrix(const std::string& path)
+    : m_mapping(0), m_mapping_size(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file for reading: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(BinaryCsrHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Binary CSR file is truncated: " + path);
+    }
+    m_mapping_size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(0, m_mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping stays valid after closing the descriptor
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot memory-map file: " + path);
+    }
+    m_mapping = mapping;
+
+    // The arrays are used in place, so they are checked as thoroughly as
+    // read_binary_csr checks its copies (one pass over offsets and columns)
+    const BinaryCsrHeader& h = *static_cast<const BinaryCsrHeader*>(m_mapping);
+    const char* base = static_cast<const char*>(m_mapping);
+    try {
+        check_binary_header(h, m_mapping_size, path);
+        check_binary_offsets(h, reinterpret_cast<const size_t*>(base + h.row_offsets_offset), path);
+        check_binary_columns(h, reinterpret_cast<const size_t*>(base + h.col_indices_offset), path);
+    } catch (...) {
+        ::munmap(m_mapping, m_mapping_size);
+        throw;
+    }
+
+    m_num_rows = h.num_rows;
+    m_num_cols = h.num_cols;
+    m_nnz = h.nnz;
+    m_row_offsets = reinterpret_cast<const size_t*>(base + h.row_offsets_offset);
+    m_col_indices = reinterpret_cast<const size_t*>(base + h.col_indices_offset);
+    m_values = reinterpret_cast<const double*>(base + h.values_offset);
+}
+
+MappedSparseMatrix::~MappedSparseMatrix() {
+    if (m_mapping) {
+        ::munmap(m_mapping, m_mapping_size);
+    }
+}
+
+Vector MappedSparseMatrix::operator*(const Vector& x) const {
+    Vector result(m_num_rows);
+    multiply(x, result);
+    return result;
+}
+
+void MappedSparseMatrix::multiply(const Vector& x, Vector& y) const {
+    csr_multiply(m_num_rows, m_num_cols, m_row_offsets, m_col_indices, m_values, x, y);
+}
+
+SparseMatrix MappedSparseMatrix::toSparseMatrix() const {
+    DoubleArray values;
+    IndexArray col_indices, row_offsets;
+    csr_place_copy(m_num_rows, m_row_offsets, m_col_indices, m_values, values, col_indices, row_offsets);
+    return SparseMatrix(m_num_rows, m_num_cols,
+                        std::move(values), std::move(col_indices), std::move(row_offsets));
+}
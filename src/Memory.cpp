@@ -0,0 +1,146 @@
+// in file: src/Memory.cpp
+#include "Memory.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+// POSIX aligned allocation and memory advice
+#include <sys/mman.h>
+
+namespace {
+
+// Blocks at least this large are huge-page aligned and advised
+const size_t kHugePageBytes = size_t(2) << 20;
+
+size_t round_up(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+std::atomic<MemoryResource*> g_default_resource(nullptr);
+
+} // namespace
+
+// --- AlignedResource ---
+
+void* AlignedResource::allocate(size_t bytes) {
+    if (bytes == 0) {
+        bytes = kMemoryAlignment;
+    }
+    const bool huge = bytes >= kHugePageBytes;
+    const size_t alignment = huge ? kHugePageBytes : kMemoryAlignment;
+    const size_t size = round_up(bytes, alignment);
+
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, size) != 0) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    // Only advice: without transparent huge pages this fails harmlessly
+    if (huge) {
+        madvise(p, size, MADV_HUGEPAGE);
+    }
+#endif
+    return p;
+}
+
+void AlignedResource::deallocate(void* p, size_t) {
+    std::free(p);
+}
+
+AlignedResource& AlignedResource::instance() {
+    static AlignedResource resource;
+    return resource;
+}
+
+// --- PoolResource ---
+
+PoolResource::PoolResource(MemoryResource& upstream, size_t max_cached_bytes)
+    : m_upstream(upstream), m_max_cached_bytes(max_cached_bytes) {}
+
+PoolResource::~PoolResource() {
+    release();
+}
+
+void* PoolResource::allocate(size_t bytes) {
+    const size_t size = round_up(bytes == 0 ? 1 : bytes, kMemoryAlignment);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.allocations;
+        std::map<size_t, std::vector<void*> >::iterator it = m_free.find(size);
+        if (it != m_free.end() && !it->second.empty()) {
+            void* p = it->second.back();
+            it->second.pop_back();
+            m_stats.cached_bytes -= size;
+            ++m_stats.reuses;
+            return p;
+        }
+    }
+    return m_upstream.allocate(size);
+}
+
+void PoolResource::deallocate(void* p, size_t bytes) {
+    if (p == nullptr) {
+        return;
+    }
+    const size_t size = round_up(bytes == 0 ? 1 : bytes, kMemoryAlignment);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stats.cached_bytes + size <= m_max_cached_bytes) {
+            m_free[size].push_back(p);
+            m_stats.cached_bytes += size;
+            return;
+        }
+    }
+    m_upstream.deallocate(p, size);
+}
+
+void PoolResource::release() {
+    std::map<size_t, std::vector<void*> > blocks;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        blocks.swap(m_free);
+        m_stats.cached_bytes = 0;
+    }
+    for (std::map<size_t, std::vector<void*> >::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        for (size_t q = 0; q < it->second.size(); ++q) {
+            m_upstream.deallocate(it->second[q], it->first);
+        }
+    }
+}
+
+PoolResource::Stats PoolResource::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+// --- Default resource ---
+
+PoolResource& global_memory_pool() {
+    // Never destroyed: static arrays may free into it during program exit
+    static PoolResource* pool = new PoolResource();
+    return *pool;
+}
+
+MemoryResource& default_memory_resource() {
+    MemoryResource* resource = g_default_resource.load(std::memory_order_acquire);
+    return resource ? *resource : global_memory_pool();
+}
+
+void set_default_memory_resource(MemoryResource* resource) {
+    g_default_resource.store(resource, std::memory_order_release);
+}
+
+// --- Parallel first touch ---
+
+void parallel_fill(double* data, size_t n, double value) {
+    parallel_blocks(n, parallel_block_count(n), [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) data[i] = value;
+    });
+}
+
+void parallel_copy(const double* src, double* dst, size_t n) {
+    parallel_blocks(n, parallel_block_count(n), [&](size_t begin, size_t end, size_t) {
+        if (end > begin) std::memcpy(dst + begin, src + begin, (end - begin) * sizeof(double));
+    });
+}
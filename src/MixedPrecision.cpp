@@ -0,0 +1,197 @@
+// in file: src/MixedPrecision.cpp
+#include "MixedPrecision.hpp"
+#include "Timing.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Float BLAS-1 helpers. Dot products accumulate in double: it costs nothing
+// (the loop is bandwidth-bound) and keeps alpha and beta accurate.
+double dot_float(const float* a, const float* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+    }
+    return sum;
+}
+
+} // namespace
+
+MixedPrecisionCG::MixedPrecisionCG(const SparseMatrix& A)
+    : m_A(A), m_A_float(A), m_inner_tolerance(1e-4) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("MixedPrecisionCG requires a square matrix");
+    }
+}
+
+void MixedPrecisionCG::setInnerTolerance(double tolerance) {
+    if (!(tolerance > 0.0 && tolerance < 1.0)) {
+        throw std::invalid_argument("Inner tolerance must be in (0, 1)");
+    }
+    m_inner_tolerance = tolerance;
+}
+
+// Plain CG in float on A d = rf (||rf|| = 1), starting from d = 0.
+// m_rf is used as the inner residual and is overwritten.
+size_t MixedPrecisionCG::innerSolve(size_t max_iter, SolveReport& report) const {
+    const size_t n = m_A.rows();
+    float* d = m_d.data();
+    float* r = m_rf.data();
+    float* p = m_p.data();
+    float* Ap = m_Ap.data();
+
+    Clock::time_point t = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        d[i] = 0.0f;
+        p[i] = r[i];
+    }
+    report.time_update += seconds_since(t);
+
+    t = Clock::now();
+    double r_dot_r = dot_float(r, r, n);
+    report.time_dot += seconds_since(t);
+
+    size_t k = 0;
+    while (k < max_iter && std::sqrt(r_dot_r) > m_inner_tolerance) {
+        t = Clock::now();
+        m_A_float.multiply(p, Ap);
+        report.time_spmv += seconds_since(t);
+
+        t = Clock::now();
+        double p_dot_Ap = dot_float(p, Ap, n);
+        report.time_dot += seconds_since(t);
+        if (!(p_dot_Ap > 0.0) || !std::isfinite(p_dot_Ap)) {
+            break;
+        }
+
+        // d += alpha p, r -= alpha Ap, with r . r from the same pass
+        t = Clock::now();
+        const float alpha = static_cast<float>(r_dot_r / p_dot_Ap);
+        double r_dot_r_new = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            d[i] += alpha * p[i];
+            float v = r[i] - alpha * Ap[i];
+            r[i] = v;
+            r_dot_r_new += static_cast<double>(v) * v;
+        }
+
+        // p = r + beta p
+        const float beta = static_cast<float>(r_dot_r_new / r_dot_r);
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = r[i] + beta * p[i];
+        }
+        report.time_update += seconds_since(t);
+
+        r_dot_r = r_dot_r_new;
+        ++k;
+    }
+    return k;
+}
+
+SolveReport MixedPrecisionCG::solve(const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                                    SolveMonitor* monitor) const {
+    const size_t n = m_A.rows();
+    if (b.size() != n || x.size() != n) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+
+    Clock::time_point begin = Clock::now();
+    SolveReport report;
+    m_r.resize(n);
+    m_rf.resize(n);
+    m_d.resize(n);
+    m_p.resize(n);
+    m_Ap.resize(n);
+
+    // True residual in double: r = b - A x
+    Clock::time_point t = Clock::now();
+    m_A.multiply(x, m_r);
+    report.time_spmv += seconds_since(t);
+    t = Clock::now();
+    m_r.xpay(b, -1.0);
+    report.time_update += seconds_since(t);
+    t = Clock::now();
+    double b_norm = norm(b);
+    double r_norm = norm(m_r);
+    report.time_dot += seconds_since(t);
+    report.residual_history.push_back(r_norm);
+
+    size_t total = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    while (true) {
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
+        }
+        if (total >= max_iter) {
+            break;
+        }
+
+        // Round the unit-norm residual to float and solve A d = r / ||r||
+        t = Clock::now();
+        const double* r = m_r.data();
+        const double inv_r_norm = 1.0 / r_norm;
+        for (size_t i = 0; i < n; ++i) {
+            m_rf[i] = static_cast<float>(r[i] * inv_r_norm);
+        }
+        report.time_update += seconds_since(t);
+
+        size_t used = innerSolve(max_iter - total, report);
+        total += used;
+        if (used == 0) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+
+        // Correction in double: x += ||r|| d
+        t = Clock::now();
+        double* px = x.data();
+        for (size_t i = 0; i < n; ++i) {
+            px[i] += r_norm * static_cast<double>(m_d[i]);
+        }
+        report.time_update += seconds_since(t);
+
+        t = Clock::now();
+        m_A.multiply(x, m_r);
+        report.time_spmv += seconds_since(t);
+        t = Clock::now();
+        m_r.xpay(b, -1.0);
+        report.time_update += seconds_since(t);
+        t = Clock::now();
+        double new_r_norm = norm(m_r);
+        report.time_dot += seconds_since(t);
+
+        // If refinement no longer reduces the residual, the tolerance is below
+        // what the float inner solve can deliver for this matrix
+        bool stagnated = !(new_r_norm < r_norm);
+        r_norm = new_r_norm;
+        report.residual_history.push_back(r_norm);
+
+        if (monitor) {
+            IterationState state = { total, r_norm, b_norm > 0.0 ? r_norm / b_norm : r_norm, x, m_r };
+            if (!monitor->onIteration(state)) {
+                reason = ConvergenceReason::StoppedByMonitor;
+                break;
+            }
+        }
+        if (stagnated && r_norm > tolerance * b_norm) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+    }
+
+    report.iterations = total;
+    report.reason = reason;
+    report.initial_residual = report.residual_history.front();
+    report.final_residual = report.residual_history.back();
+    report.time_total = seconds_since(begin);
+    return report;
+}
+
+Vector solve_cg_mixed(const SparseMatrix& A, const Vector& b, const Vector& x0, size_t max_iter, double tolerance) {
+    Vector x = x0;
+    MixedPrecisionCG solver(A);
+    solver.solve(b, x, max_iter, tolerance);
+    return x;
+}
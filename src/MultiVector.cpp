@@ -0,0 +1,71 @@
+// in file: src/MultiVector.cpp
+#include "MultiVector.hpp"
+#include "LinearOperator.hpp"
+#include <stdexcept>
+
+MultiVector::MultiVector() : m_rows(0), m_cols(0) {}
+
+MultiVector::MultiVector(size_t rows, size_t cols)
+    : m_rows(rows), m_cols(cols), m_data(rows * cols, 0.0) {}
+
+double& MultiVector::operator()(size_t row, size_t col) {
+    if (row >= m_rows || col >= m_cols) {
+        throw std::out_of_range("MultiVector index out of range");
+    }
+    return m_data[row * m_cols + col];
+}
+
+const double& MultiVector::operator()(size_t row, size_t col) const {
+    if (row >= m_rows || col >= m_cols) {
+        throw std::out_of_range("MultiVector index out of range");
+    }
+    return m_data[row * m_cols + col];
+}
+
+Vector MultiVector::column(size_t j) const {
+    if (j >= m_cols) {
+        throw std::out_of_range("MultiVector column out of range");
+    }
+    Vector v(m_rows);
+    double* pv = v.data();
+    for (size_t i = 0; i < m_rows; ++i) {
+        pv[i] = m_data[i * m_cols + j];
+    }
+    return v;
+}
+
+void MultiVector::setColumn(size_t j, const Vector& v) {
+    if (j >= m_cols) {
+        throw std::out_of_range("MultiVector column out of range");
+    }
+    if (v.size() != m_rows) {
+        throw std::length_error("Vector size must match MultiVector row count");
+    }
+    const double* pv = v.data();
+    for (size_t i = 0; i < m_rows; ++i) {
+        m_data[i * m_cols + j] = pv[i];
+    }
+}
+
+void MultiVector::resize(size_t rows, size_t cols) {
+    if (rows == m_rows && cols == m_cols) {
+        return;
+    }
+    m_rows = rows;
+    m_cols = cols;
+    m_data.assign(rows * cols, 0.0);
+}
+
+// Default block product of LinearOperator: one multiply() per column
+void LinearOperator::multiplyBlock(const MultiVector& X, MultiVector& Y) const {
+    if (X.rows() != cols() || Y.rows() != rows() || X.cols() != Y.cols()) {
+        throw std::length_error("MultiVector shapes must match the operator");
+    }
+    Vector x(cols());
+    Vector y(rows());
+    for (size_t j = 0; j < X.cols(); ++j) {
+        x = X.column(j);
+        multiply(x, y);
+        Y.setColumn(j, y);
+    }
+}
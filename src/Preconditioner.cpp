@@ -0,0 +1,358 @@
+// in file: src/Preconditioner.cpp
+#include "Preconditioner.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <algorithm> // For std::sort, std::max, std::fill, std::copy, std::equal
+#include <utility>   // For std::pair
+#include <cmath>
+
+namespace {
+
+// Levels with fewer rows than this are solved serially (waking the pool costs more)
+const size_t kParallelLevelMinRows = 2048;
+
+// Extracts the diagonal of A; every diagonal entry must be present and non-zero
+std::vector<double> extract_diagonal(const SparseMatrix& A) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Preconditioner requires a square matrix");
+    }
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+    const DoubleArray& values = A.values();
+
+    std::vector<double> diag(A.rows(), 0.0);
+    for (size_t i = 0; i < A.rows(); ++i) {
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (col_indices[k] == i) {
+                diag[i] += values[k];
+            }
+        }
+        if (diag[i] == 0.0) {
+            throw std::runtime_error("Preconditioner requires a non-zero diagonal");
+        }
+    }
+    return diag;
+}
+
+void check_sizes(size_t n, const Vector& r, const Vector& z) {
+    if (r.size() != n || z.size() != n) {
+        throw std::length_error("Preconditioner and Vector sizes must match");
+    }
+}
+
+} // namespace
+
+void Preconditioner::updateValues(const SparseMatrix&) {
+    throw std::runtime_error("This preconditioner does not support value updates; rebuild it");
+}
+
+// --- Jacobi ---
+
+JacobiPreconditioner::JacobiPreconditioner(const SparseMatrix& A) {
+    updateValues(A);
+}
+
+void JacobiPreconditioner::updateValues(const SparseMatrix& A) {
+    m_inv_diag = extract_diagonal(A);
+    for (size_t i = 0; i < m_inv_diag.size(); ++i) {
+        m_inv_diag[i] = 1.0 / m_inv_diag[i];
+    }
+}
+
+// z_i = r_i / a_ii
+void JacobiPreconditioner::apply(const Vector& r, Vector& z) const {
+    check_sizes(m_inv_diag.size(), r, z);
+    const double* pr = r.data();
+    double* pz = z.data();
+    const double* inv = m_inv_diag.data();
+    for (size_t i = 0; i < m_inv_diag.size(); ++i) {
+        pz[i] = inv[i] * pr[i];
+    }
+}
+
+// --- SSOR / Symmetric Gauss-Seidel ---
+
+SSORPreconditioner::SSORPreconditioner(const SparseMatrix& A, double omega)
+    : m_A(A), m_omega(omega), m_diag(extract_diagonal(A)) {
+    if (omega <= 0.0 || omega >= 2.0) {
+        throw std::invalid_argument("SSOR relaxation factor must be in (0, 2)");
+    }
+}
+
+void SSORPreconditioner::updateValues(const SparseMatrix& A) {
+    if (&A != &m_A) {
+        throw std::invalid_argument("SSOR preconditioner can only be updated with the matrix it references");
+    }
+    m_diag = extract_diagonal(A);
+}
+
+void SSORPreconditioner::apply(const Vector& r, Vector& z) const {
+    const size_t n = m_diag.size();
+    check_sizes(n, r, z);
+
+    const size_t* row_offsets = m_A.rowOffsets().data();
+    const size_t* col_indices = m_A.colIndices().data();
+    const double* values = m_A.values().data();
+    const double* pr = r.data();
+    double* pz = z.data();
+    const double w = m_omega;
+
+    // 1. Forward sweep: (D/w + L) y = r, y stored in z
+    for (size_t i = 0; i < n; ++i) {
+        double sum = pr[i];
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (col_indices[k] < i) {
+                sum -= values[k] * pz[col_indices[k]];
+            }
+        }
+        pz[i] = sum * w / m_diag[i];
+    }
+
+    // 2. Backward sweep: (D/w + U) z = (D/w) y
+    for (size_t i = n; i-- > 0; ) {
+        double sum = m_diag[i] / w * pz[i];
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (col_indices[k] > i) {
+                sum -= values[k] * pz[col_indices[k]];
+            }
+        }
+        pz[i] = sum * w / m_diag[i];
+    }
+
+    // 3. Scale so that M is the symmetric SSOR operator
+    const double factor = (2.0 - w) / w;
+    for (size_t i = 0; i < n; ++i) {
+        pz[i] *= factor;
+    }
+}
+
+// --- Incomplete Cholesky IC(0) ---
+
+const size_t IC0Preconditioner::kDropped;
+
+IC0Preconditioner::IC0Preconditioner(const SparseMatrix& A) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Preconditioner requires a square matrix");
+    }
+    const size_t n = A.rows();
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+
+    // 1. Pattern of the strictly lower triangle, sorted by column with duplicates
+    //    merged, and the destination of every entry of A
+    m_lower.row_offsets.assign(n + 1, 0);
+    m_source.assign(A.nnz(), kDropped);
+    std::vector<size_t> diag_entries;
+    std::vector<std::pair<size_t, size_t> > row; // (column, entry of A)
+    for (size_t i = 0; i < n; ++i) {
+        row.clear();
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (col_indices[k] < i) {
+                row.push_back(std::make_pair(col_indices[k], k));
+            } else if (col_indices[k] == i) {
+                diag_entries.push_back(k);
+                m_source[k] = i; // offset by nnz(L) below
+            }
+        }
+        std::sort(row.begin(), row.end());
+        for (size_t k = 0; k < row.size(); ++k) {
+            if (k == 0 || row[k].first != row[k - 1].first) {
+                m_lower.col_indices.push_back(row[k].first);
+            }
+            m_source[row[k].second] = m_lower.col_indices.size() - 1;
+        }
+        m_lower.row_offsets[i + 1] = m_lower.col_indices.size();
+    }
+    const size_t lower_nnz = m_lower.col_indices.size();
+    for (size_t d = 0; d < diag_entries.size(); ++d) {
+        m_source[diag_entries[d]] += lower_nnz;
+    }
+    m_lower.values.assign(lower_nnz, 0.0);
+    m_lower.diag.assign(n, 0.0);
+
+    // 2. Pattern of U = L^T (a counting sort by column)
+    m_upper.row_offsets.assign(n + 1, 0);
+    for (size_t k = 0; k < lower_nnz; ++k) {
+        m_upper.row_offsets[m_lower.col_indices[k] + 1]++;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        m_upper.row_offsets[i + 1] += m_upper.row_offsets[i];
+    }
+    m_upper.col_indices.resize(lower_nnz);
+    m_upper.values.assign(lower_nnz, 0.0);
+    m_upper.diag.assign(n, 0.0);
+    m_upper_source.resize(lower_nnz);
+    {
+        std::vector<size_t> next(m_upper.row_offsets.begin(), m_upper.row_offsets.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = m_lower.row_offsets[i]; k < m_lower.row_offsets[i + 1]; ++k) {
+                size_t pos = next[m_lower.col_indices[k]]++;
+                m_upper.col_indices[pos] = i;
+                m_upper_source[pos] = k;
+            }
+        }
+    }
+
+    // 3. Level schedules for both triangular solves
+    m_lower_levels = buildLevels(m_lower, true);
+    m_upper_levels = buildLevels(m_upper, false);
+
+    // 4. Pattern of A, checked by updateValues() before m_source is reused
+    m_pattern_offsets.assign(row_offsets.begin(), row_offsets.end());
+    m_pattern_cols.assign(col_indices.begin(), col_indices.end());
+
+    // 5. Numeric factorization
+    factorize(A.values());
+}
+
+void IC0Preconditioner::updateValues(const SparseMatrix& A) {
+    // Equal nnz is not enough: m_source maps entry k of A to a slot of the
+    // factor, so every row offset and column index must match
+    if (A.rows() != m_lower.diag.size() || A.nnz() != m_source.size() ||
+        !std::equal(m_pattern_offsets.begin(), m_pattern_offsets.end(), A.rowOffsets().begin()) ||
+        !std::equal(m_pattern_cols.begin(), m_pattern_cols.end(), A.colIndices().begin())) {
+        throw std::invalid_argument("Matrix does not have the sparsity pattern of the preconditioner");
+    }
+    factorize(A.values());
+}
+
+void IC0Preconditioner::factorize(const DoubleArray& values) {
+    const size_t n = m_lower.diag.size();
+    const size_t lower_nnz = m_lower.values.size();
+    const size_t* L_offsets = m_lower.row_offsets.data();
+    const size_t* L_cols = m_lower.col_indices.data();
+    double* L_vals = m_lower.values.data();
+    double* L_diag = m_lower.diag.data();
+
+    // 1. Gather the lower triangle and the diagonal of A (duplicates summed)
+    std::fill(m_lower.values.begin(), m_lower.values.end(), 0.0);
+    std::fill(m_lower.diag.begin(), m_lower.diag.end(), 0.0);
+    for (size_t k = 0; k < m_source.size(); ++k) {
+        const size_t dest = m_source[k];
+        if (dest == kDropped) {
+            continue;
+        }
+        if (dest < lower_nnz) {
+            L_vals[dest] += values[k];
+        } else {
+            L_diag[dest - lower_nnz] += values[k];
+        }
+    }
+
+    // 2. Row by row:
+    //    L_ij = (a_ij - sum_{m<j} L_im L_jm) / L_jj,   L_ii = sqrt(a_ii - sum_{m<i} L_im^2)
+    // Only entries inside the pattern of A are kept (zero fill-in).
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = L_offsets[i]; k < L_offsets[i + 1]; ++k) {
+            size_t j = L_cols[k];
+
+            // Sparse dot product of row i (entries before k) with row j, both sorted
+            double s = L_vals[k];
+            size_t a = L_offsets[i];
+            size_t b = L_offsets[j];
+            while (a < k && b < L_offsets[j + 1]) {
+                if (L_cols[a] == L_cols[b]) {
+                    s -= L_vals[a] * L_vals[b];
+                    ++a;
+                    ++b;
+                } else if (L_cols[a] < L_cols[b]) {
+                    ++a;
+                } else {
+                    ++b;
+                }
+            }
+            L_vals[k] = s / L_diag[j];
+        }
+
+        double d = L_diag[i];
+        for (size_t k = L_offsets[i]; k < L_offsets[i + 1]; ++k) {
+            d -= L_vals[k] * L_vals[k];
+        }
+        if (!(d > 0.0)) {
+            throw std::runtime_error("IC(0) breakdown: non-positive pivot (matrix not SPD?)");
+        }
+        L_diag[i] = std::sqrt(d);
+    }
+
+    // 3. Copy the values into U = L^T
+    std::copy(m_lower.diag.begin(), m_lower.diag.end(), m_upper.diag.begin());
+    for (size_t k = 0; k < m_upper_source.size(); ++k) {
+        m_upper.values[k] = L_vals[m_upper_source[k]];
+    }
+}
+
+// level(i) = 1 + max level(j) over the rows j that row i depends on
+IC0Preconditioner::LevelSchedule IC0Preconditioner::buildLevels(const Triangle& T, bool lower) {
+    const size_t n = T.diag.size();
+    std::vector<size_t> level(n, 0);
+    size_t num_levels = 0;
+    for (size_t step = 0; step < n; ++step) {
+        size_t i = lower ? step : n - 1 - step;
+        size_t l = 0;
+        for (size_t k = T.row_offsets[i]; k < T.row_offsets[i + 1]; ++k) {
+            l = std::max(l, level[T.col_indices[k]] + 1);
+        }
+        level[i] = l;
+        num_levels = std::max(num_levels, l + 1);
+    }
+
+    // Group rows by level (counting sort keeps rows ascending inside a level)
+    LevelSchedule schedule;
+    schedule.offsets.assign(num_levels + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        schedule.offsets[level[i] + 1]++;
+    }
+    for (size_t l = 0; l < num_levels; ++l) {
+        schedule.offsets[l + 1] += schedule.offsets[l];
+    }
+    schedule.rows.resize(n);
+    std::vector<size_t> next(schedule.offsets.begin(), schedule.offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        schedule.rows[next[level[i]]++] = i;
+    }
+    return schedule;
+}
+
+// Triangular solve: out_i = (rhs_i - sum_j T_ij out_j) / T_ii, one level at a time
+void IC0Preconditioner::solve(const Triangle& T, const LevelSchedule& levels,
+                              const double* rhs, double* out) {
+    const size_t* offsets = T.row_offsets.data();
+    const size_t* cols = T.col_indices.data();
+    const double* vals = T.values.data();
+    const double* diag = T.diag.data();
+    const size_t* rows = levels.rows.data();
+
+    ThreadPool& pool = ThreadPool::global();
+    for (size_t l = 0; l + 1 < levels.offsets.size(); ++l) {
+        const size_t begin = levels.offsets[l];
+        const size_t end = levels.offsets[l + 1];
+
+        // Rows inside one level are independent of each other
+        auto solve_rows = [&](size_t first, size_t last) {
+            for (size_t r = first; r < last; ++r) {
+                size_t i = rows[r];
+                double sum = rhs[i];
+                for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    sum -= vals[k] * out[cols[k]];
+                }
+                out[i] = sum / diag[i];
+            }
+        };
+
+        if (pool.size() == 1 || end - begin < kParallelLevelMinRows) {
+            solve_rows(begin, end);
+        } else {
+            pool.run([&](size_t tid, size_t num_threads) {
+                solve_rows(begin + (end - begin) * tid / num_threads,
+                           begin + (end - begin) * (tid + 1) / num_threads);
+            });
+        }
+    }
+}
+
+// z = (L L^T)^-1 r: forward solve with L, then backward solve with L^T (in place in z)
+void IC0Preconditioner::apply(const Vector& r, Vector& z) const {
+    check_sizes(m_lower.diag.size(), r, z);
+    solve(m_lower, m_lower_levels, r.data(), z.data());
+    solve(m_upper, m_upper_levels, z.data(), z.data());
+}
@@ -0,0 +1,427 @@
+// in file: src/Reordering.cpp
+#include "Reordering.hpp"
+#include <stdexcept>
+#include <algorithm> // For std::sort, std::reverse
+#include <utility>   // For std::pair
+
+namespace {
+
+// Default part size of the RecursiveBisection ordering (rows per part)
+const size_t kRowsPerPart = 2048;
+
+void require_square(const SparseMatrix& A) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Reordering requires a square matrix");
+    }
+}
+
+// Breadth-first searches on the graph of A, restricted to the rows whose
+// label in 'part' equals a given value and that are not numbered yet
+class GraphSearch {
+public:
+    GraphSearch(const SparseMatrix& A, const std::vector<size_t>& part)
+        : m_offsets(A.rowOffsets().data()), m_cols(A.colIndices().data()), m_part(part),
+          m_numbered(A.rows(), 0), m_mark(A.rows(), 0), m_stamp(0) {}
+
+    size_t degree(size_t v) const { return m_offsets[v + 1] - m_offsets[v]; }
+
+    bool inside(size_t v, size_t p) const { return m_part[v] == p && !m_numbered[v]; }
+
+    // Level structure rooted at start: m_queue holds the visited rows level by
+    // level. Returns the number of levels; last_level is where the deepest begins.
+    size_t levels(size_t start, size_t p, size_t& last_level) {
+        ++m_stamp;
+        m_queue.clear();
+        m_queue.push_back(start);
+        m_mark[start] = m_stamp;
+        size_t level_begin = 0;
+        size_t num_levels = 0;
+        while (level_begin < m_queue.size()) {
+            const size_t level_end = m_queue.size();
+            last_level = level_begin;
+            ++num_levels;
+            for (size_t q = level_begin; q < level_end; ++q) {
+                const size_t v = m_queue[q];
+                for (size_t k = m_offsets[v]; k < m_offsets[v + 1]; ++k) {
+                    const size_t u = m_cols[k];
+                    if (inside(u, p) && m_mark[u] != m_stamp) {
+                        m_mark[u] = m_stamp;
+                        m_queue.push_back(u);
+                    }
+                }
+            }
+            level_begin = level_end;
+        }
+        return num_levels;
+    }
+
+    // George-Liu: repeatedly restart from a minimum-degree row of the deepest
+    // level while that makes the level structure deeper
+    size_t pseudoPeripheral(size_t start, size_t p) {
+        size_t last_level = 0;
+        size_t depth = levels(start, p, last_level);
+        for (size_t attempt = 0; attempt < 8; ++attempt) {
+            size_t candidate = m_queue[last_level];
+            for (size_t q = last_level + 1; q < m_queue.size(); ++q) {
+                if (degree(m_queue[q]) < degree(candidate)) candidate = m_queue[q];
+            }
+            size_t candidate_last = 0;
+            const size_t candidate_depth = levels(candidate, p, candidate_last);
+            if (candidate_depth <= depth) {
+                break;
+            }
+            start = candidate;
+            depth = candidate_depth;
+            last_level = candidate_last;
+        }
+        return start;
+    }
+
+    // Appends the Cuthill-McKee order of the component of start to order:
+    // breadth-first, neighbours of each row in increasing degree
+    void cuthillMcKee(size_t start, size_t p, std::vector<size_t>& order) {
+        size_t head = order.size();
+        order.push_back(start);
+        m_numbered[start] = 1;
+        while (head < order.size()) {
+            const size_t v = order[head++];
+            m_neighbours.clear();
+            for (size_t k = m_offsets[v]; k < m_offsets[v + 1]; ++k) {
+                const size_t u = m_cols[k];
+                if (inside(u, p)) {
+                    m_numbered[u] = 1;
+                    m_neighbours.push_back(std::make_pair(degree(u), u));
+                }
+            }
+            std::sort(m_neighbours.begin(), m_neighbours.end());
+            for (size_t q = 0; q < m_neighbours.size(); ++q) {
+                order.push_back(m_neighbours[q].second);
+            }
+        }
+    }
+
+    const size_t* offsets() const { return m_offsets; }
+    const size_t* cols() const { return m_cols; }
+
+private:
+    const size_t* m_offsets;
+    const size_t* m_cols;
+    const std::vector<size_t>& m_part;
+    std::vector<char> m_numbered;
+    std::vector<size_t> m_mark;  // m_mark[v] == m_stamp: visited by the current search
+    size_t m_stamp;
+    std::vector<size_t> m_queue;
+    std::vector<std::pair<size_t, size_t> > m_neighbours; // (degree, row)
+};
+
+// Appends the reverse Cuthill-McKee order of the rows in 'vertices' (all labelled p).
+// Every connected component starts from a pseudo-peripheral row found from
+// its lowest-degree row.
+void order_part(GraphSearch& search, const std::vector<size_t>& vertices, size_t p,
+                std::vector<size_t>& order) {
+    std::vector<std::pair<size_t, size_t> > by_degree(vertices.size());
+    for (size_t q = 0; q < vertices.size(); ++q) {
+        by_degree[q] = std::make_pair(search.degree(vertices[q]), vertices[q]);
+    }
+    std::sort(by_degree.begin(), by_degree.end());
+
+    const size_t first = order.size();
+    for (size_t q = 0; q < by_degree.size(); ++q) {
+        const size_t v = by_degree[q].second;
+        if (search.inside(v, p)) {
+            search.cuthillMcKee(search.pseudoPeripheral(v, p), p, order);
+        }
+    }
+    std::reverse(order.begin() + first, order.end());
+}
+
+// Splits the rows in 'vertices' (all labelled first_part) into num_parts parts
+// labelled first_part .. first_part + num_parts - 1
+void bisect(GraphSearch& search, std::vector<size_t>& part, std::vector<size_t>& vertices,
+            size_t first_part, size_t num_parts) {
+    const size_t n = vertices.size();
+    if (num_parts < 2 || n < 2) {
+        return;
+    }
+    const size_t left_parts = num_parts / 2;
+    const size_t left_label = first_part;
+    const size_t right_label = first_part + left_parts;
+    const size_t target = n * left_parts / num_parts;
+    const size_t* offsets = search.offsets();
+    const size_t* cols = search.cols();
+
+    // 1. Greedy graph growing: the first 'target' rows reached breadth-first
+    //    from a pseudo-peripheral row form the left half
+    const size_t seed = search.pseudoPeripheral(vertices[0], left_label);
+    for (size_t q = 0; q < n; ++q) part[vertices[q]] = right_label;
+
+    std::vector<size_t> queue;
+    queue.reserve(target);
+    size_t head = 0;
+    size_t next_seed = 0;
+    size_t left_size = 0;
+    if (target > 0) {
+        part[seed] = left_label;
+        queue.push_back(seed);
+        left_size = 1;
+    }
+    while (left_size < target) {
+        if (head == queue.size()) {
+            // Component exhausted: continue from another right row
+            while (part[vertices[next_seed]] != right_label) ++next_seed;
+            part[vertices[next_seed]] = left_label;
+            queue.push_back(vertices[next_seed]);
+            ++left_size;
+            continue;
+        }
+        const size_t v = queue[head++];
+        for (size_t k = offsets[v]; k < offsets[v + 1] && left_size < target; ++k) {
+            const size_t u = cols[k];
+            if (part[u] == right_label) {
+                part[u] = left_label;
+                queue.push_back(u);
+                ++left_size;
+            }
+        }
+    }
+
+    // 2. Boundary refinement: move rows that have more neighbours on the other
+    //    side, as long as the halves stay within 1% of their target sizes
+    const size_t slack = std::max<size_t>(1, n / 100);
+    for (size_t pass = 0; pass < 4; ++pass) {
+        size_t moved = 0;
+        for (size_t q = 0; q < n; ++q) {
+            const size_t v = vertices[q];
+            const size_t side = part[v];
+            const size_t other = (side == left_label) ? right_label : left_label;
+            long gain = 0;
+            for (size_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+                const size_t u = cols[k];
+                if (u == v) continue;
+                if (part[u] == other) ++gain;
+                else if (part[u] == side) --gain;
+            }
+            if (gain <= 0) {
+                continue;
+            }
+            const size_t new_left = (side == left_label) ? left_size - 1 : left_size + 1;
+            if (new_left + slack < target || new_left > target + slack) {
+                continue;
+            }
+            part[v] = other;
+            left_size = new_left;
+            ++moved;
+        }
+        if (moved == 0) {
+            break;
+        }
+    }
+
+    // 3. Recurse into both halves
+    std::vector<size_t> left, right;
+    left.reserve(left_size);
+    right.reserve(n - left_size);
+    for (size_t q = 0; q < n; ++q) {
+        (part[vertices[q]] == left_label ? left : right).push_back(vertices[q]);
+    }
+    std::vector<size_t>().swap(vertices);
+    bisect(search, part, left, left_label, left_parts);
+    bisect(search, part, right, right_label, num_parts - left_parts);
+}
+
+void check_permutation_size(const std::vector<size_t>& perm, size_t n) {
+    if (perm.size() != n) {
+        throw std::length_error("Permutation size must match");
+    }
+}
+
+// out[i] = v[perm[i]]
+void gather(const Vector& v, const std::vector<size_t>& perm, Vector& out) {
+    check_permutation_size(perm, v.size());
+    out.resize(v.size());
+    const double* pv = v.data();
+    double* po = out.data();
+    for (size_t i = 0; i < perm.size(); ++i) po[i] = pv[perm[i]];
+}
+
+// out[perm[i]] = w[i]
+void scatter(const Vector& w, const std::vector<size_t>& perm, Vector& out) {
+    check_permutation_size(perm, w.size());
+    out.resize(w.size());
+    const double* pw = w.data();
+    double* po = out.data();
+    for (size_t i = 0; i < perm.size(); ++i) po[perm[i]] = pw[i];
+}
+
+std::vector<size_t> make_ordering(const SparseMatrix& A, Ordering ordering, size_t num_parts) {
+    switch (ordering) {
+        case Ordering::ReverseCuthillMcKee:
+            return reverse_cuthill_mckee(A);
+        case Ordering::RecursiveBisection:
+            if (num_parts == 0) {
+                num_parts = std::max<size_t>(1, A.rows() / kRowsPerPart);
+            }
+            return bisection_ordering(A, num_parts);
+        case Ordering::Natural:
+        default: {
+            std::vector<size_t> identity(A.rows());
+            for (size_t i = 0; i < identity.size(); ++i) identity[i] = i;
+            return identity;
+        }
+    }
+}
+
+} // namespace
+
+std::vector<size_t> reverse_cuthill_mckee(const SparseMatrix& A) {
+    require_square(A);
+    std::vector<size_t> part(A.rows(), 0);
+    std::vector<size_t> vertices(A.rows());
+    for (size_t i = 0; i < vertices.size(); ++i) vertices[i] = i;
+
+    GraphSearch search(A, part);
+    std::vector<size_t> order;
+    order.reserve(A.rows());
+    order_part(search, vertices, 0, order);
+    return order;
+}
+
+std::vector<size_t> partition_graph(const SparseMatrix& A, size_t num_parts) {
+    require_square(A);
+    if (num_parts == 0) {
+        throw std::invalid_argument("Number of parts must be positive");
+    }
+    std::vector<size_t> part(A.rows(), 0);
+    std::vector<size_t> vertices(A.rows());
+    for (size_t i = 0; i < vertices.size(); ++i) vertices[i] = i;
+
+    GraphSearch search(A, part);
+    bisect(search, part, vertices, 0, num_parts);
+    return part;
+}
+
+std::vector<size_t> bisection_ordering(const SparseMatrix& A, size_t num_parts) {
+    const std::vector<size_t> part = partition_graph(A, num_parts);
+
+    // Rows of each part, in increasing index (counting sort by part)
+    std::vector<size_t> part_offsets(num_parts + 1, 0);
+    for (size_t i = 0; i < part.size(); ++i) part_offsets[part[i] + 1]++;
+    for (size_t p = 0; p < num_parts; ++p) part_offsets[p + 1] += part_offsets[p];
+    std::vector<size_t> by_part(part.size());
+    std::vector<size_t> next(part_offsets.begin(), part_offsets.end() - 1);
+    for (size_t i = 0; i < part.size(); ++i) by_part[next[part[i]]++] = i;
+
+    GraphSearch search(A, part);
+    std::vector<size_t> order;
+    order.reserve(A.rows());
+    std::vector<size_t> vertices;
+    for (size_t p = 0; p < num_parts; ++p) {
+        vertices.assign(by_part.begin() + part_offsets[p], by_part.begin() + part_offsets[p + 1]);
+        order_part(search, vertices, p, order);
+    }
+    return order;
+}
+
+std::vector<size_t> inverse_permutation(const std::vector<size_t>& perm) {
+    const size_t none = static_cast<size_t>(-1);
+    std::vector<size_t> inverse(perm.size(), none);
+    for (size_t i = 0; i < perm.size(); ++i) {
+        if (perm[i] >= perm.size() || inverse[perm[i]] != none) {
+            throw std::invalid_argument("Not a permutation");
+        }
+        inverse[perm[i]] = i;
+    }
+    return inverse;
+}
+
+SparseMatrix permute_symmetric(const SparseMatrix& A, const std::vector<size_t>& perm) {
+    require_square(A);
+    check_permutation_size(perm, A.rows());
+    const std::vector<size_t> inverse = inverse_permutation(perm);
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+    const DoubleArray& values = A.values();
+    const size_t n = A.rows();
+
+    std::vector<size_t> new_offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        new_offsets[i + 1] = new_offsets[i] + (row_offsets[perm[i] + 1] - row_offsets[perm[i]]);
+    }
+
+    // Rows are independent: each pool thread fills (and first touches) its own
+    DoubleArray b_values(A.nnz());
+    IndexArray b_cols(A.nnz());
+    IndexArray b_offsets(n + 1);
+    csr_row_blocks(n, new_offsets.data(), [&](size_t begin, size_t end) {
+        std::vector<std::pair<size_t, double> > row;
+        for (size_t i = begin; i < end; ++i) {
+            const size_t old = perm[i];
+            b_offsets[i] = new_offsets[i];
+            row.clear();
+            for (size_t k = row_offsets[old]; k < row_offsets[old + 1]; ++k) {
+                row.push_back(std::make_pair(inverse[col_indices[k]], values[k]));
+            }
+            std::sort(row.begin(), row.end());
+            for (size_t q = 0; q < row.size(); ++q) {
+                b_cols[new_offsets[i] + q] = row[q].first;
+                b_values[new_offsets[i] + q] = row[q].second;
+            }
+        }
+    });
+    b_offsets[n] = new_offsets[n];
+    return SparseMatrix(n, n, std::move(b_values), std::move(b_cols), std::move(b_offsets));
+}
+
+Vector permute_vector(const Vector& v, const std::vector<size_t>& perm) {
+    Vector w(v.size());
+    gather(v, perm, w);
+    return w;
+}
+
+Vector unpermute_vector(const Vector& w, const std::vector<size_t>& perm) {
+    Vector v(w.size());
+    scatter(w, perm, v);
+    return v;
+}
+
+size_t matrix_bandwidth(const SparseMatrix& A) {
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+    size_t bandwidth = 0;
+    for (size_t i = 0; i < A.rows(); ++i) {
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            const size_t j = col_indices[k];
+            bandwidth = std::max(bandwidth, j > i ? j - i : i - j);
+        }
+    }
+    return bandwidth;
+}
+
+// --- ReorderedSystem ---
+
+ReorderedSystem::ReorderedSystem(const SparseMatrix& A, Ordering ordering, size_t num_parts)
+    : m_perm(make_ordering(A, ordering, num_parts)), m_A(permute_symmetric(A, m_perm)) {}
+
+SolveReport ReorderedSystem::solve(const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                                   SolveMonitor* monitor) const {
+    if (b.size() != m_A.rows() || x.size() != m_A.rows()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+    gather(b, m_perm, m_b);
+    gather(x, m_perm, m_x);
+    SolveReport report = solve_cg(m_A, m_b, m_x, max_iter, tolerance, m_workspace, monitor);
+    scatter(m_x, m_perm, x);
+    return report;
+}
+
+SolveReport ReorderedSystem::solve(const Vector& b, Vector& x, const Preconditioner& M, size_t max_iter,
+                                   double tolerance, SolveMonitor* monitor) const {
+    if (b.size() != m_A.rows() || x.size() != m_A.rows()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+    gather(b, m_perm, m_b);
+    gather(x, m_perm, m_x);
+    SolveReport report = solve_pcg(m_A, m_b, m_x, M, max_iter, tolerance, m_workspace, monitor);
+    scatter(m_x, m_perm, x);
+    return report;
+}
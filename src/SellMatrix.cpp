@@ -0,0 +1,252 @@
+// in file: src/SellMatrix.cpp
+#include "SellMatrix.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <algorithm> // For std::stable_sort, std::lower_bound
+
+#if CFD_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+const size_t SellMatrix::kChunkHeight;
+
+namespace {
+
+const size_t C = SellMatrix::kChunkHeight;
+
+// Everything a chunk kernel needs, gathered in one place
+struct SellView {
+    const size_t* chunk_offsets;
+    const size_t* chunk_widths;
+    const double* values;
+    const uint32_t* col_indices;
+    const size_t* permutation;
+    size_t num_rows;
+};
+
+// Writes the C row sums of chunk c back to their original row positions
+inline void scatter_chunk(const SellView& A, size_t c, const double* sums, double* y) {
+    for (size_t lane = 0; lane < C; ++lane) {
+        size_t row = c * C + lane;
+        if (row < A.num_rows) {
+            y[A.permutation[row]] = sums[lane];
+        }
+    }
+}
+
+// Portable kernel: one accumulator per lane, columns visited in CSR order
+void sell_chunks_scalar(const SellView& A, size_t chunk_begin, size_t chunk_end,
+                        const double* x, double* y) {
+    for (size_t c = chunk_begin; c < chunk_end; ++c) {
+        double sums[C] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        const double* val = A.values + A.chunk_offsets[c];
+        const uint32_t* col = A.col_indices + A.chunk_offsets[c];
+        for (size_t j = 0; j < A.chunk_widths[c]; ++j) {
+            for (size_t lane = 0; lane < C; ++lane) {
+                sums[lane] += val[j * C + lane] * x[col[j * C + lane]];
+            }
+        }
+        scatter_chunk(A, c, sums, y);
+    }
+}
+
+#if CFD_X86_DISPATCH
+// AVX2: the 8 lanes of a chunk column are split over two 4-wide registers.
+// A separate multiply and add (no FMA) keeps the rounding identical to the scalar kernel.
+__attribute__((target("avx2")))
+void sell_chunks_avx2(const SellView& A, size_t chunk_begin, size_t chunk_end,
+                      const double* x, double* y) {
+    for (size_t c = chunk_begin; c < chunk_end; ++c) {
+        __m256d lo = _mm256_setzero_pd();
+        __m256d hi = _mm256_setzero_pd();
+        const double* val = A.values + A.chunk_offsets[c];
+        const uint32_t* col = A.col_indices + A.chunk_offsets[c];
+        for (size_t j = 0; j < A.chunk_widths[c]; ++j) {
+            __m128i idx_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + j * C));
+            __m128i idx_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + j * C + 4));
+            __m256d x_lo = _mm256_i32gather_pd(x, idx_lo, 8);
+            __m256d x_hi = _mm256_i32gather_pd(x, idx_hi, 8);
+            lo = _mm256_add_pd(lo, _mm256_mul_pd(_mm256_loadu_pd(val + j * C), x_lo));
+            hi = _mm256_add_pd(hi, _mm256_mul_pd(_mm256_loadu_pd(val + j * C + 4), x_hi));
+        }
+        double sums[C];
+        _mm256_storeu_pd(sums, lo);
+        _mm256_storeu_pd(sums + 4, hi);
+        scatter_chunk(A, c, sums, y);
+    }
+}
+
+// AVX-512: one register holds a whole chunk column
+__attribute__((target("avx512f")))
+void sell_chunks_avx512(const SellView& A, size_t chunk_begin, size_t chunk_end,
+                        const double* x, double* y) {
+    for (size_t c = chunk_begin; c < chunk_end; ++c) {
+        __m512d acc = _mm512_setzero_pd();
+        const double* val = A.values + A.chunk_offsets[c];
+        const uint32_t* col = A.col_indices + A.chunk_offsets[c];
+        for (size_t j = 0; j < A.chunk_widths[c]; ++j) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + j * C));
+            __m512d xv = _mm512_i32gather_pd(idx, x, 8);
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(_mm512_loadu_pd(val + j * C), xv));
+        }
+        double sums[C];
+        _mm512_storeu_pd(sums, acc);
+        scatter_chunk(A, c, sums, y);
+    }
+}
+#endif
+
+void sell_chunks(SellMatrix::Kernel kernel, const SellView& A,
+                 size_t chunk_begin, size_t chunk_end, const double* x, double* y) {
+#if CFD_X86_DISPATCH
+    if (kernel == SellMatrix::AVX512) {
+        sell_chunks_avx512(A, chunk_begin, chunk_end, x, y);
+        return;
+    }
+    if (kernel == SellMatrix::AVX2) {
+        sell_chunks_avx2(A, chunk_begin, chunk_end, x, y);
+        return;
+    }
+#endif
+    sell_chunks_scalar(A, chunk_begin, chunk_end, x, y);
+}
+
+// The gathers read their 32-bit indices as signed, so columns >= 2^31 need the scalar kernel
+bool gather_indices_fit(size_t num_cols) {
+    return num_cols <= 0x80000000u;
+}
+
+} // namespace
+
+// Conversion from CSR
+SellMatrix::SellMatrix(const SparseMatrix& A, size_t sigma)
+    : m_num_rows(A.rows()), m_num_cols(A.cols()), m_nnz(A.nnz()), m_kernel(Scalar) {
+
+    if (m_num_cols > 0xFFFFFFFFu) {
+        throw std::overflow_error("SellMatrix stores 32-bit column indices; matrix has too many columns");
+    }
+    if (sigma == 0) {
+        sigma = 1;
+    }
+
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+    const DoubleArray& values = A.values();
+
+    // 1. Sort rows by length (longest first) inside each window of sigma rows
+    m_permutation.resize(m_num_rows);
+    for (size_t i = 0; i < m_num_rows; ++i) {
+        m_permutation[i] = i;
+    }
+    for (size_t begin = 0; begin < m_num_rows; begin += sigma) {
+        size_t end = std::min(begin + sigma, m_num_rows);
+        std::stable_sort(m_permutation.begin() + begin, m_permutation.begin() + end,
+                         [&](size_t a, size_t b) {
+                             return row_offsets[a + 1] - row_offsets[a] > row_offsets[b + 1] - row_offsets[b];
+                         });
+    }
+
+    // 2. Chunk widths and offsets
+    const size_t num_chunks = (m_num_rows + C - 1) / C;
+    m_chunk_widths.assign(num_chunks, 0);
+    m_chunk_offsets.assign(num_chunks + 1, 0);
+    for (size_t c = 0; c < num_chunks; ++c) {
+        size_t width = 0;
+        for (size_t lane = 0; lane < C && c * C + lane < m_num_rows; ++lane) {
+            size_t row = m_permutation[c * C + lane];
+            width = std::max(width, row_offsets[row + 1] - row_offsets[row]);
+        }
+        m_chunk_widths[c] = width;
+        m_chunk_offsets[c + 1] = m_chunk_offsets[c] + width * C;
+    }
+
+    // 3. Fill values column by column. Padding multiplies 0.0 with an entry of
+    // x the row already reads, so it adds nothing and stays in cache.
+    m_values.assign(m_chunk_offsets[num_chunks], 0.0);
+    m_col_indices.assign(m_chunk_offsets[num_chunks], 0);
+    for (size_t c = 0; c < num_chunks; ++c) {
+        for (size_t lane = 0; lane < C && c * C + lane < m_num_rows; ++lane) {
+            size_t row = m_permutation[c * C + lane];
+            size_t start = row_offsets[row];
+            size_t length = row_offsets[row + 1] - start;
+            uint32_t pad_col = length > 0 ? static_cast<uint32_t>(col_indices[start + length - 1]) : 0;
+            for (size_t j = 0; j < m_chunk_widths[c]; ++j) {
+                size_t pos = m_chunk_offsets[c] + j * C + lane;
+                if (j < length) {
+                    m_values[pos] = values[start + j];
+                    m_col_indices[pos] = static_cast<uint32_t>(col_indices[start + j]);
+                } else {
+                    m_col_indices[pos] = pad_col;
+                }
+            }
+        }
+    }
+
+    // 4. Pick the widest SIMD kernel this CPU supports
+    if (!gather_indices_fit(m_num_cols)) {
+        return;
+    }
+    if (cpu_has_avx512f()) {
+        m_kernel = AVX512;
+    } else if (cpu_has_avx2()) {
+        m_kernel = AVX2;
+    }
+}
+
+void SellMatrix::setKernel(Kernel kernel) {
+    if ((kernel == AVX512 && !cpu_has_avx512f()) || (kernel == AVX2 && !cpu_has_avx2())) {
+        throw std::runtime_error("Requested SIMD kernel is not supported by this CPU");
+    }
+    if (kernel != Scalar && !gather_indices_fit(m_num_cols)) {
+        throw std::runtime_error("SIMD kernels need fewer than 2^31 columns");
+    }
+    m_kernel = kernel;
+}
+
+Vector SellMatrix::operator*(const Vector& x) const {
+    Vector result(m_num_rows);
+    multiply(x, result);
+    return result;
+}
+
+void SellMatrix::multiply(const Vector& x, Vector& y) const {
+    if (m_num_cols != x.size()) {
+        throw std::length_error("Matrix column count must match Vector size");
+    }
+    if (m_num_rows != y.size()) {
+        throw std::length_error("Result Vector size must match Matrix row count");
+    }
+
+    SellView view;
+    view.chunk_offsets = m_chunk_offsets.data();
+    view.chunk_widths = m_chunk_widths.data();
+    view.values = m_values.data();
+    view.col_indices = m_col_indices.data();
+    view.permutation = m_permutation.data();
+    view.num_rows = m_num_rows;
+
+    const size_t num_chunks = m_chunk_widths.size();
+    const double* px = x.data();
+    double* py = y.data();
+    const Kernel kernel = m_kernel;
+
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || m_values.size() < kParallelMinWork) {
+        sell_chunks(kernel, view, 0, num_chunks, px, py);
+        return;
+    }
+
+    // Split the chunks so every thread gets about the same number of stored entries
+    pool.run([&](size_t tid, size_t num_threads) {
+        const size_t total = m_chunk_offsets[num_chunks];
+        size_t lo = total * tid / num_threads;
+        size_t hi = total * (tid + 1) / num_threads;
+        size_t begin = std::lower_bound(m_chunk_offsets.begin(), m_chunk_offsets.end() - 1, lo) - m_chunk_offsets.begin();
+        size_t end = std::lower_bound(m_chunk_offsets.begin(), m_chunk_offsets.end() - 1, hi) - m_chunk_offsets.begin();
+        if (tid + 1 == num_threads) {
+            end = num_chunks;
+        }
+        sell_chunks(kernel, view, begin, end, px, py);
+    });
+}
@@ -2,6 +2,9 @@
 #include "SparseMatrix.hpp"
 #include <stdexcept>
 #include <iostream>
+#include <utility> // For std::move
+#include <algorithm> // For std::lower_bound, std::sort
+#include "ThreadPool.hpp"
 
 // Constructor Implementation
 SparseMatrix::SparseMatrix(size_t num_rows, size_t num_cols, size_t capacity)
@@ -14,6 +17,53 @@ SparseMatrix::SparseMatrix(size_t num_rows, size_t num_cols, size_t capacity)
     m_row_offsets.resize(num_rows + 1, 0);
 }
 
+namespace {
+
+// Validates CSR arrays before a constructor accepts them
+void check_csr_sizes(size_t num_rows, size_t nnz_values, size_t nnz_cols, size_t num_offsets,
+                     size_t last_offset) {
+    if (num_offsets != num_rows + 1) {
+        throw std::invalid_argument("CSR row_offsets must have num_rows + 1 entries");
+    }
+    if (nnz_values != nnz_cols || last_offset != nnz_values) {
+        throw std::invalid_argument("CSR values, col_indices and row_offsets sizes do not match");
+    }
+}
+
+} // namespace
+
+// Constructor from finished aligned CSR arrays: the storage is taken over as is
+SparseMatrix::SparseMatrix(size_t num_rows, size_t num_cols,
+                           DoubleArray&& values,
+                           IndexArray&& col_indices,
+                           IndexArray&& row_offsets)
+    : m_num_rows(num_rows), m_num_cols(num_cols) {
+    check_csr_sizes(num_rows, values.size(), col_indices.size(), row_offsets.size(),
+                    row_offsets.empty() ? 0 : row_offsets.back());
+    m_values = std::move(values);
+    m_col_indices = std::move(col_indices);
+    m_row_offsets = std::move(row_offsets);
+}
+
+// Constructor from plain std::vector CSR arrays
+// The arrays are copied into aligned storage by the threads that will run
+// multiply(), so those pages are first touched by the thread using them.
+SparseMatrix::SparseMatrix(size_t num_rows, size_t num_cols,
+                           std::vector<double>&& values,
+                           std::vector<size_t>&& col_indices,
+                           std::vector<size_t>&& row_offsets)
+    : m_num_rows(num_rows), m_num_cols(num_cols) {
+    check_csr_sizes(num_rows, values.size(), col_indices.size(), row_offsets.size(),
+                    row_offsets.empty() ? 0 : row_offsets.back());
+    csr_place_copy(m_num_rows, row_offsets.data(), col_indices.data(), values.data(),
+                   m_values, m_col_indices, m_row_offsets);
+
+    // The inputs were handed over: free them now rather than with the caller's objects
+    std::vector<double>().swap(values);
+    std::vector<size_t>().swap(col_indices);
+    std::vector<size_t>().swap(row_offsets);
+}
+
 // Simplified setValue method (Assumes values are added in row-major order)
 void SparseMatrix::setValue(size_t row, size_t col, double value) {
     if (row >= m_num_rows || col >= m_num_cols) {
@@ -31,34 +81,277 @@ void SparseMatrix::setValue(size_t row, size_t col, double value) {
     }
 }
 
-// Core Operation: Matrix-Vector Multiplication (y = A * x)
-Vector SparseMatrix::operator*(const Vector& x) const {
-    if (m_num_cols != x.size()) {
+namespace {
+
+// SpMV kernel for the rows [row_begin, row_end).
+// Both the serial and the parallel path call this, so every row is summed in
+// exactly the same order and the results match bit-for-bit.
+void spmv_rows(size_t row_begin, size_t row_end,
+               const size_t* row_offsets, const size_t* col_indices, const double* values,
+               const double* x, double* y) {
+    for (size_t i = row_begin; i < row_end; ++i) {
+        double sum = 0.0;
+
+        // Determine the start and end index in the values array for this row (i)
+        size_t start = row_offsets[i];
+        size_t end   = row_offsets[i+1];
+
+        // Loop through only the non-zero elements in the current row
+        for (size_t k = start; k < end; ++k) {
+            // Formula: sum += A_ik * x_k
+            // values[k] is A_ik, col_indices[k] is the column index j
+            sum += values[k] * x[col_indices[k]];
+        }
+
+        y[i] = sum;
+    }
+}
+
+// --- SpMM: rows of Y = A * X for a row-major X with k columns ---
+// With k known at compile time the k sums live in registers.
+template <size_t K>
+void spmm_rows_fixed(size_t row_begin, size_t row_end,
+                     const size_t* row_offsets, const size_t* col_indices, const double* values,
+                     const double* X, double* Y) {
+    for (size_t i = row_begin; i < row_end; ++i) {
+        double sum[K];
+        for (size_t j = 0; j < K; ++j) sum[j] = 0.0;
+        for (size_t k = row_offsets[i]; k < row_offsets[i+1]; ++k) {
+            const double a = values[k];
+            const double* x = X + col_indices[k] * K;
+            for (size_t j = 0; j < K; ++j) sum[j] += a * x[j];
+        }
+        double* y = Y + i * K;
+        for (size_t j = 0; j < K; ++j) y[j] = sum[j];
+    }
+}
+
+// Any k: accumulate straight into the output row, which stays in L1
+void spmm_rows(size_t row_begin, size_t row_end,
+               const size_t* row_offsets, const size_t* col_indices, const double* values,
+               const double* X, double* Y, size_t num_vecs) {
+    switch (num_vecs) {
+        case 1: spmm_rows_fixed<1>(row_begin, row_end, row_offsets, col_indices, values, X, Y); return;
+        case 2: spmm_rows_fixed<2>(row_begin, row_end, row_offsets, col_indices, values, X, Y); return;
+        case 4: spmm_rows_fixed<4>(row_begin, row_end, row_offsets, col_indices, values, X, Y); return;
+        case 8: spmm_rows_fixed<8>(row_begin, row_end, row_offsets, col_indices, values, X, Y); return;
+        default: break;
+    }
+    for (size_t i = row_begin; i < row_end; ++i) {
+        double* y = Y + i * num_vecs;
+        for (size_t j = 0; j < num_vecs; ++j) y[j] = 0.0;
+        for (size_t k = row_offsets[i]; k < row_offsets[i+1]; ++k) {
+            const double a = values[k];
+            const double* x = X + col_indices[k] * num_vecs;
+            for (size_t j = 0; j < num_vecs; ++j) y[j] += a * x[j];
+        }
+    }
+}
+
+} // namespace
+
+// Row partition balanced by non-zeros (not by row count)
+// For each boundary p we look for the first row whose offset reaches p/num_parts
+// of the total nnz, so irregular meshes still give every thread similar work.
+std::vector<size_t> csr_row_partition(size_t num_rows, const size_t* row_offsets, size_t num_parts) {
+    if (num_parts == 0) {
+        num_parts = 1;
+    }
+    std::vector<size_t> bounds(num_parts + 1, 0);
+    const size_t total = row_offsets[num_rows];
+    for (size_t p = 1; p < num_parts; ++p) {
+        size_t target = static_cast<size_t>((static_cast<double>(total) * p) / num_parts);
+        bounds[p] = std::lower_bound(row_offsets, row_offsets + num_rows + 1, target) - row_offsets;
+        if (bounds[p] > num_rows) {
+            bounds[p] = num_rows;
+        }
+        if (bounds[p] < bounds[p - 1]) {
+            bounds[p] = bounds[p - 1];
+        }
+    }
+    bounds[num_parts] = num_rows;
+    return bounds;
+}
+
+void csr_place_copy(size_t num_rows, const size_t* row_offsets, const size_t* col_indices,
+                    const double* values, DoubleArray& dst_values, IndexArray& dst_cols,
+                    IndexArray& dst_offsets) {
+    const size_t nnz = row_offsets[num_rows];
+    // Sized without writing (see AlignedAllocator): the row blocks touch the pages first
+    dst_values = DoubleArray(nnz);
+    dst_cols = IndexArray(nnz);
+    dst_offsets = IndexArray(num_rows + 1);
+    csr_row_blocks(num_rows, row_offsets, [&](size_t begin, size_t end) {
+        const size_t k_begin = row_offsets[begin];
+        const size_t k_end = row_offsets[end];
+        std::copy(row_offsets + begin, row_offsets + end, dst_offsets.data() + begin);
+        std::copy(col_indices + k_begin, col_indices + k_end, dst_cols.data() + k_begin);
+        std::copy(values + k_begin, values + k_end, dst_values.data() + k_begin);
+    });
+    dst_offsets[num_rows] = nnz;
+}
+
+// Raw CSR product y = A * x, serial or threaded
+void csr_multiply(size_t num_rows, size_t num_cols,
+                  const size_t* row_offsets, const size_t* col_indices, const double* values,
+                  const Vector& x, Vector& y) {
+    if (num_cols != x.size()) {
         throw std::length_error("Matrix column count must match Vector size");
     }
+    if (num_rows != y.size()) {
+        throw std::length_error("Result Vector size must match Matrix row count");
+    }
+
+    const double* px = x.data();
+    double* py = y.data();
 
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || row_offsets[num_rows] < kParallelMinWork) {
+        spmv_rows(0, num_rows, row_offsets, col_indices, values, px, py);
+        return;
+    }
+
+    // Each thread handles one nnz-balanced block of rows
+    const std::vector<size_t> bounds = csr_row_partition(num_rows, row_offsets, pool.size());
+    pool.run([&](size_t tid, size_t num_threads) {
+        size_t begin = bounds[tid * (bounds.size() - 1) / num_threads];
+        size_t end = bounds[(tid + 1) * (bounds.size() - 1) / num_threads];
+        spmv_rows(begin, end, row_offsets, col_indices, values, px, py);
+    });
+}
+
+void SparseMatrix::multiplyBlock(const MultiVector& X, MultiVector& Y) const {
+    if (X.rows() != m_num_cols) {
+        throw std::length_error("Matrix column count must match MultiVector row count");
+    }
+    if (Y.rows() != m_num_rows || Y.cols() != X.cols()) {
+        throw std::length_error("Result MultiVector must be rows() x X.cols()");
+    }
+
+    const size_t k = X.cols();
+    const size_t* offsets = m_row_offsets.data();
+    const size_t* cols = m_col_indices.data();
+    const double* vals = m_values.data();
+
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || nnz() * k < kParallelMinWork) {
+        spmm_rows(0, m_num_rows, offsets, cols, vals, X.data(), Y.data(), k);
+        return;
+    }
+
+    const std::vector<size_t> bounds = rowPartition(pool.size());
+    pool.run([&](size_t tid, size_t num_threads) {
+        size_t begin = bounds[tid * (bounds.size() - 1) / num_threads];
+        size_t end = bounds[(tid + 1) * (bounds.size() - 1) / num_threads];
+        spmm_rows(begin, end, offsets, cols, vals, X.data(), Y.data(), k);
+    });
+}
+
+MultiVector SparseMatrix::operator*(const MultiVector& X) const {
+    MultiVector result(m_num_rows, X.cols());
+    multiplyBlock(X, result);
+    return result;
+}
+
+size_t SparseMatrix::findSlot(size_t row, size_t col) const {
+    if (row >= m_num_rows || col >= m_num_cols) {
+        throw std::out_of_range("Matrix index out of bounds");
+    }
+    const size_t* first = m_col_indices.data() + m_row_offsets[row];
+    const size_t* last = m_col_indices.data() + m_row_offsets[row + 1];
+    const size_t* it = std::lower_bound(first, last, col);
+    if (it == last || *it != col) {
+        throw std::out_of_range("Matrix entry is not part of the sparsity pattern");
+    }
+    return static_cast<size_t>(it - m_col_indices.data());
+}
+
+std::vector<size_t> SparseMatrix::rowPartition(size_t num_parts) const {
+    return csr_row_partition(m_num_rows, m_row_offsets.data(), num_parts);
+}
+
+// Core Operation: Matrix-Vector Multiplication (y = A * x)
+Vector SparseMatrix::operator*(const Vector& x) const {
     // Initialize the result vector (y)
     Vector result(m_num_rows);
+    multiply(x, result);
+    return result;
+}
+
+// In-place Matrix-Vector Multiplication, serial or threaded
+void SparseMatrix::multiply(const Vector& x, Vector& y) const {
+    csr_multiply(m_num_rows, m_num_cols, m_row_offsets.data(), m_col_indices.data(),
+                 m_values.data(), x, y);
+}
+
+// Transpose via a counting sort on the column indices: O(nnz + cols)
+// Visiting rows in order means each output row comes out with sorted columns.
+SparseMatrix SparseMatrix::transpose() const {
+    IndexArray t_offsets(m_num_cols + 1, 0);
+    for (size_t k = 0; k < m_col_indices.size(); ++k) {
+        t_offsets[m_col_indices[k] + 1]++;
+    }
+    for (size_t j = 0; j < m_num_cols; ++j) {
+        t_offsets[j + 1] += t_offsets[j];
+    }
 
-    // Loop through each row of the matrix
+    IndexArray t_cols(m_col_indices.size());
+    DoubleArray t_values(m_values.size());
+    std::vector<size_t> next(t_offsets.begin(), t_offsets.end() - 1);
     for (size_t i = 0; i < m_num_rows; ++i) {
-        double sum = 0.0;
-        
-        // Determine the start and end index in the m_values array for this row (i)
-        size_t start = m_row_offsets[i];
-        size_t end   = m_row_offsets[i+1];
+        for (size_t k = m_row_offsets[i]; k < m_row_offsets[i+1]; ++k) {
+            size_t pos = next[m_col_indices[k]]++;
+            t_cols[pos] = i;
+            t_values[pos] = m_values[k];
+        }
+    }
 
-        // Loop through only the non-zero elements in the current row
-        for (size_t k = start; k < end; ++k) {
-            // Formula: sum += A_ik * x_k
-            // m_values[k] is A_ik
-            // m_col_indices[k] is the column index j (k)
-            // x[m_col_indices[k]] is the corresponding element in the input vector x
-            sum += m_values[k] * x[m_col_indices[k]];
+    return SparseMatrix(m_num_cols, m_num_rows,
+                        std::move(t_values), std::move(t_cols), std::move(t_offsets));
+}
+
+// Sparse Matrix-Matrix Multiplication (C = A * B)
+// Row i of C is the sum of the rows k of B, weighted by A_ik. A dense
+// accumulator of size B.cols() collects the row; 'marker' remembers which
+// columns are already in use so the accumulator never has to be cleared.
+SparseMatrix SparseMatrix::operator*(const SparseMatrix& B) const {
+    if (m_num_cols != B.m_num_rows) {
+        throw std::length_error("Matrix dimensions do not match for multiplication");
+    }
+
+    const size_t none = static_cast<size_t>(-1);
+    std::vector<size_t> marker(B.m_num_cols, none);
+    std::vector<double> accumulator(B.m_num_cols, 0.0);
+    std::vector<size_t> row_cols;
+
+    IndexArray c_offsets(m_num_rows + 1, 0);
+    IndexArray c_cols;
+    DoubleArray c_values;
+
+    for (size_t i = 0; i < m_num_rows; ++i) {
+        row_cols.clear();
+        for (size_t ka = m_row_offsets[i]; ka < m_row_offsets[i+1]; ++ka) {
+            size_t k = m_col_indices[ka];
+            double a_ik = m_values[ka];
+            for (size_t kb = B.m_row_offsets[k]; kb < B.m_row_offsets[k+1]; ++kb) {
+                size_t j = B.m_col_indices[kb];
+                if (marker[j] != i) {
+                    marker[j] = i;
+                    accumulator[j] = 0.0;
+                    row_cols.push_back(j);
+                }
+                accumulator[j] += a_ik * B.m_values[kb];
+            }
         }
-        
-        result[i] = sum;
+
+        std::sort(row_cols.begin(), row_cols.end());
+        for (size_t k = 0; k < row_cols.size(); ++k) {
+            c_cols.push_back(row_cols[k]);
+            c_values.push_back(accumulator[row_cols[k]]);
+        }
+        c_offsets[i + 1] = c_cols.size();
     }
 
-    return result;
+    return SparseMatrix(m_num_rows, B.m_num_cols,
+                        std::move(c_values), std::move(c_cols), std::move(c_offsets));
 }
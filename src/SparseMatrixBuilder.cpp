@@ -0,0 +1,163 @@
+// in file: src/SparseMatrixBuilder.cpp
+#include "SparseMatrixBuilder.hpp"
+#include <stdexcept>
+#include <utility> // For std::move
+
+// Constructor: one (initially empty) triplet buffer per slot
+SparseMatrixBuilder::SparseMatrixBuilder(size_t num_rows, size_t num_cols, size_t num_slots)
+    : m_num_rows(num_rows), m_num_cols(num_cols), m_slots(num_slots) {
+    if (num_slots == 0) {
+        throw std::invalid_argument("SparseMatrixBuilder needs at least one slot");
+    }
+}
+
+void SparseMatrixBuilder::reserve(size_t capacity, size_t slot) {
+    Slot& s = m_slots.at(slot);
+    s.rows.reserve(capacity);
+    s.cols.reserve(capacity);
+    s.values.reserve(capacity);
+}
+
+// Appending is O(1): no ordering is required at this stage
+void SparseMatrixBuilder::addValue(size_t row, size_t col, double value, size_t slot) {
+    if (row >= m_num_rows || col >= m_num_cols) {
+        throw std::out_of_range("Matrix index out of bounds");
+    }
+    if (slot >= m_slots.size()) {
+        throw std::out_of_range("Builder slot out of range");
+    }
+
+    Slot& s = m_slots[slot];
+    s.rows.push_back(row);
+    s.cols.push_back(col);
+    s.values.push_back(value);
+}
+
+size_t SparseMatrixBuilder::size() const {
+    size_t total = 0;
+    for (size_t s = 0; s < m_slots.size(); ++s) {
+        total += m_slots[s].values.size();
+    }
+    return total;
+}
+
+// Finalize: two counting sorts (an LSD radix sort on the key (row, col))
+SparseMatrix SparseMatrixBuilder::build() {
+    const size_t total = size();
+
+    // 1. Counting sort by column.
+    // col_start[c] becomes the first output position for column c.
+    std::vector<size_t> col_start(m_num_cols + 1, 0);
+    for (size_t s = 0; s < m_slots.size(); ++s) {
+        const std::vector<size_t>& cols = m_slots[s].cols;
+        for (size_t k = 0; k < cols.size(); ++k) {
+            col_start[cols[k] + 1]++;
+        }
+    }
+    for (size_t c = 0; c < m_num_cols; ++c) {
+        col_start[c + 1] += col_start[c];
+    }
+
+    std::vector<size_t> by_col_rows(total);
+    std::vector<size_t> by_col_cols(total);
+    std::vector<double> by_col_values(total);
+    for (size_t s = 0; s < m_slots.size(); ++s) {
+        const Slot& slot = m_slots[s];
+        for (size_t k = 0; k < slot.values.size(); ++k) {
+            size_t pos = col_start[slot.cols[k]]++;
+            by_col_rows[pos] = slot.rows[k];
+            by_col_cols[pos] = slot.cols[k];
+            by_col_values[pos] = slot.values[k];
+        }
+    }
+
+    // The triplet buffers are no longer needed; release them early
+    m_slots.assign(m_slots.size(), Slot());
+
+    // 2. Stable counting sort by row.
+    // Because step 1 already ordered by column, entries end up sorted by (row, col).
+    std::vector<size_t> row_offsets(m_num_rows + 1, 0);
+    for (size_t k = 0; k < total; ++k) {
+        row_offsets[by_col_rows[k] + 1]++;
+    }
+    for (size_t r = 0; r < m_num_rows; ++r) {
+        row_offsets[r + 1] += row_offsets[r];
+    }
+
+    std::vector<size_t> sorted_cols(total);
+    std::vector<double> sorted_values(total);
+    {
+        std::vector<size_t> next(row_offsets.begin(), row_offsets.end() - 1);
+        for (size_t k = 0; k < total; ++k) {
+            size_t pos = next[by_col_rows[k]]++;
+            sorted_cols[pos] = by_col_cols[k];
+            sorted_values[pos] = by_col_values[k];
+        }
+    }
+    // Step 1's buffers are no longer needed either
+    std::vector<size_t>().swap(by_col_rows);
+    std::vector<size_t>().swap(by_col_cols);
+    std::vector<double>().swap(by_col_values);
+
+    // 3. Count the entries left once duplicates are merged: the final row offsets
+    std::vector<size_t> merged_offsets(m_num_rows + 1, 0);
+    for (size_t r = 0; r < m_num_rows; ++r) {
+        size_t count = 0;
+        for (size_t k = row_offsets[r]; k < row_offsets[r + 1]; ++k) {
+            if (k == row_offsets[r] || sorted_cols[k] != sorted_cols[k - 1]) {
+                ++count;
+            }
+        }
+        merged_offsets[r + 1] = merged_offsets[r] + count;
+    }
+
+    // 4. Merge duplicates straight into the matrix's aligned arrays. Each pool
+    // thread writes the rows it will own in multiply(), so it touches them first.
+    const size_t nnz = merged_offsets[m_num_rows];
+    DoubleArray values(nnz);
+    IndexArray col_indices(nnz);
+    IndexArray offsets(m_num_rows + 1);
+    csr_row_blocks(m_num_rows, merged_offsets.data(), [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            size_t write = merged_offsets[r];
+            offsets[r] = write;
+            for (size_t k = row_offsets[r]; k < row_offsets[r + 1]; ++k) {
+                if (write > merged_offsets[r] && col_indices[write - 1] == sorted_cols[k]) {
+                    values[write - 1] += sorted_values[k]; // Same (row, col): sum it
+                } else {
+                    col_indices[write] = sorted_cols[k];
+                    values[write] = sorted_values[k];
+                    ++write;
+                }
+            }
+        }
+    });
+    offsets[m_num_rows] = nnz;
+
+    // Hand the arrays over to the matrix (no copy)
+    return SparseMatrix(m_num_rows, m_num_cols,
+                        std::move(values), std::move(col_indices), std::move(offsets));
+}
+
+// Keep only triplets on or above the diagonal, then build as usual
+SymmetricSparseMatrix SparseMatrixBuilder::buildSymmetric() {
+    if (m_num_rows != m_num_cols) {
+        throw std::invalid_argument("Symmetric storage requires a square matrix");
+    }
+    for (size_t s = 0; s < m_slots.size(); ++s) {
+        Slot& slot = m_slots[s];
+        size_t write = 0;
+        for (size_t k = 0; k < slot.values.size(); ++k) {
+            if (slot.rows[k] <= slot.cols[k]) {
+                slot.rows[write] = slot.rows[k];
+                slot.cols[write] = slot.cols[k];
+                slot.values[write] = slot.values[k];
+                ++write;
+            }
+        }
+        slot.rows.resize(write);
+        slot.cols.resize(write);
+        slot.values.resize(write);
+    }
+    return SymmetricSparseMatrix::fromUpperTriangle(build());
+}
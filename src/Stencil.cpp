@@ -0,0 +1,250 @@
+// in file: src/Stencil.cpp
+#include "Stencil.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <algorithm> // For std::min, std::max
+#include <utility>   // For std::move
+
+namespace {
+
+// Tile sizes: a 2D tile touches 3 grid rows of kTileX doubles (48 KB),
+// a 3D tile 3 planes of kTileX x kTileY doubles (~200 KB, L2-sized)
+const size_t kTileX2D = 2048;
+const size_t kTileY2D = 64;
+const size_t kTileX3D = 512;
+const size_t kTileY3D = 16;
+const size_t kTileZ3D = 64;
+
+void check_sizes(size_t n, const Vector& x, const Vector& y) {
+    if (x.size() != n) {
+        throw std::length_error("Matrix column count must match Vector size");
+    }
+    if (y.size() != n) {
+        throw std::length_error("Result Vector size must match Matrix row count");
+    }
+}
+
+// Runs fn(item) for items [0, num_items), split into contiguous ranges over the pool
+template <class Fn>
+void for_each_tile(size_t num_items, size_t num_rows, Fn fn) {
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || num_rows < kParallelMinWork) {
+        for (size_t t = 0; t < num_items; ++t) {
+            fn(t);
+        }
+        return;
+    }
+    pool.run([&](size_t tid, size_t num_threads) {
+        size_t begin = num_items * tid / num_threads;
+        size_t end = num_items * (tid + 1) / num_threads;
+        for (size_t t = begin; t < end; ++t) {
+            fn(t);
+        }
+    });
+}
+
+// One grid line y[i0..i1) of the 7-point (or, with back = front = 0, 5-point) stencil.
+// Terms are added in CSR column order: back, down, left, centre, right, up, front.
+// The interior loop is branch-free so it vectorizes; the two ends are done separately.
+inline void stencil_line(size_t nx, size_t i0, size_t i1,
+                         const double* back, const double* down, const double* mid,
+                         const double* up, const double* front,
+                         double cz, double cy, double cx, double diag, double* y) {
+    for (size_t i = i0; i < i1; ++i) {
+        if (i == 0 || i + 1 == nx) {
+            double sum = 0.0;
+            if (back) sum += -cz * back[i];
+            sum += -cy * down[i];
+            if (i > 0) sum += -cx * mid[i - 1];
+            sum += diag * mid[i];
+            if (i + 1 < nx) sum += -cx * mid[i + 1];
+            sum += -cy * up[i];
+            if (front) sum += -cz * front[i];
+            y[i] = sum;
+            continue;
+        }
+
+        // From here on every i is an interior point: run the rest of the line in one tight loop
+        size_t end = std::min(i1, nx - 1);
+        if (back) {
+            for (size_t m = i; m < end; ++m) {
+                double sum = -cz * back[m];
+                sum += -cy * down[m];
+                sum += -cx * mid[m - 1];
+                sum += diag * mid[m];
+                sum += -cx * mid[m + 1];
+                sum += -cy * up[m];
+                sum += -cz * front[m];
+                y[m] = sum;
+            }
+        } else {
+            for (size_t m = i; m < end; ++m) {
+                double sum = -cy * down[m];
+                sum += -cx * mid[m - 1];
+                sum += diag * mid[m];
+                sum += -cx * mid[m + 1];
+                sum += -cy * up[m];
+                y[m] = sum;
+            }
+        }
+        i = end - 1;
+    }
+}
+
+} // namespace
+
+// --- 2D: 5-point stencil ---
+
+StencilOperator2D::StencilOperator2D(size_t nx, size_t ny, double hx, double hy,
+                                     double diffusivity, double shift)
+    : m_nx(nx), m_ny(ny),
+      m_cx(diffusivity / (hx * hx)), m_cy(diffusivity / (hy * hy)),
+      m_zeros(nx, 0.0) {
+    if (nx == 0 || ny == 0) {
+        throw std::invalid_argument("Stencil grid must have at least one node per direction");
+    }
+    m_diag = shift + 2.0 * m_cx + 2.0 * m_cy;
+}
+
+void StencilOperator2D::multiply(const Vector& x, Vector& y) const {
+    check_sizes(rows(), x, y);
+    const double* px = x.data();
+    double* py = y.data();
+    const double* zeros = m_zeros.data();
+
+    const size_t tiles_x = (m_nx + kTileX2D - 1) / kTileX2D;
+    const size_t tiles_y = (m_ny + kTileY2D - 1) / kTileY2D;
+
+    for_each_tile(tiles_x * tiles_y, rows(), [&](size_t tile) {
+        size_t i0 = (tile % tiles_x) * kTileX2D;
+        size_t i1 = std::min(i0 + kTileX2D, m_nx);
+        size_t j0 = (tile / tiles_x) * kTileY2D;
+        size_t j1 = std::min(j0 + kTileY2D, m_ny);
+        for (size_t j = j0; j < j1; ++j) {
+            const double* mid = px + j * m_nx;
+            const double* down = j > 0 ? mid - m_nx : zeros;
+            const double* up = j + 1 < m_ny ? mid + m_nx : zeros;
+            stencil_line(m_nx, i0, i1, 0, down, mid, up, 0, 0.0, m_cy, m_cx, m_diag, py + j * m_nx);
+        }
+    });
+}
+
+Vector StencilOperator2D::operator*(const Vector& x) const {
+    Vector result(rows());
+    multiply(x, result);
+    return result;
+}
+
+SparseMatrix StencilOperator2D::toSparseMatrix() const {
+    const size_t n = rows();
+    IndexArray row_offsets(n + 1, 0);
+    IndexArray col_indices;
+    DoubleArray values;
+    col_indices.reserve(5 * n);
+    values.reserve(5 * n);
+
+    // Rows are generated in order with ascending columns: down, left, centre, right, up
+    for (size_t j = 0; j < m_ny; ++j) {
+        for (size_t i = 0; i < m_nx; ++i) {
+            size_t r = i + m_nx * j;
+            if (j > 0)          { col_indices.push_back(r - m_nx); values.push_back(-m_cy); }
+            if (i > 0)          { col_indices.push_back(r - 1);    values.push_back(-m_cx); }
+            col_indices.push_back(r); values.push_back(m_diag);
+            if (i + 1 < m_nx)   { col_indices.push_back(r + 1);    values.push_back(-m_cx); }
+            if (j + 1 < m_ny)   { col_indices.push_back(r + m_nx); values.push_back(-m_cy); }
+            row_offsets[r + 1] = values.size();
+        }
+    }
+    return SparseMatrix(n, n, std::move(values), std::move(col_indices), std::move(row_offsets));
+}
+
+// --- 3D: 7-point stencil ---
+
+StencilOperator3D::StencilOperator3D(size_t nx, size_t ny, size_t nz, double hx, double hy, double hz,
+                                     double diffusivity, double shift)
+    : m_nx(nx), m_ny(ny), m_nz(nz),
+      m_cx(diffusivity / (hx * hx)), m_cy(diffusivity / (hy * hy)), m_cz(diffusivity / (hz * hz)),
+      m_zeros(nx * ny, 0.0) {
+    if (nx == 0 || ny == 0 || nz == 0) {
+        throw std::invalid_argument("Stencil grid must have at least one node per direction");
+    }
+    m_diag = shift + 2.0 * m_cx + 2.0 * m_cy + 2.0 * m_cz;
+}
+
+void StencilOperator3D::multiply(const Vector& x, Vector& y) const {
+    check_sizes(rows(), x, y);
+    const double* px = x.data();
+    double* py = y.data();
+    const size_t plane = m_nx * m_ny;
+
+    const size_t tiles_x = (m_nx + kTileX3D - 1) / kTileX3D;
+    const size_t tiles_y = (m_ny + kTileY3D - 1) / kTileY3D;
+    const size_t tiles_z = (m_nz + kTileZ3D - 1) / kTileZ3D;
+
+    // A tile is an (x, y) block that is streamed through a slab of planes,
+    // so the three planes it reads stay in cache
+    for_each_tile(tiles_x * tiles_y * tiles_z, rows(), [&](size_t tile) {
+        size_t tx = tile % tiles_x;
+        size_t ty = (tile / tiles_x) % tiles_y;
+        size_t tz = tile / (tiles_x * tiles_y);
+        size_t i0 = tx * kTileX3D, i1 = std::min(i0 + kTileX3D, m_nx);
+        size_t j0 = ty * kTileY3D, j1 = std::min(j0 + kTileY3D, m_ny);
+        size_t k0 = tz * kTileZ3D, k1 = std::min(k0 + kTileZ3D, m_nz);
+        for (size_t k = k0; k < k1; ++k) {
+            const double* p_mid = px + k * plane;
+            const double* p_back = k > 0 ? p_mid - plane : m_zeros.data();
+            const double* p_front = k + 1 < m_nz ? p_mid + plane : m_zeros.data();
+            for (size_t j = j0; j < j1; ++j) {
+                size_t line = j * m_nx;
+                const double* mid = p_mid + line;
+                const double* down = j > 0 ? mid - m_nx : m_zeros.data();
+                const double* up = j + 1 < m_ny ? mid + m_nx : m_zeros.data();
+                stencil_line(m_nx, i0, i1, p_back + line, down, mid, up, p_front + line,
+                             m_cz, m_cy, m_cx, m_diag, py + k * plane + line);
+            }
+        }
+    });
+}
+
+Vector StencilOperator3D::operator*(const Vector& x) const {
+    Vector result(rows());
+    multiply(x, result);
+    return result;
+}
+
+SparseMatrix StencilOperator3D::toSparseMatrix() const {
+    const size_t n = rows();
+    const size_t plane = m_nx * m_ny;
+    IndexArray row_offsets(n + 1, 0);
+    IndexArray col_indices;
+    DoubleArray values;
+    col_indices.reserve(7 * n);
+    values.reserve(7 * n);
+
+    for (size_t k = 0; k < m_nz; ++k) {
+        for (size_t j = 0; j < m_ny; ++j) {
+            for (size_t i = 0; i < m_nx; ++i) {
+                size_t r = i + m_nx * (j + m_ny * k);
+                if (k > 0)          { col_indices.push_back(r - plane); values.push_back(-m_cz); }
+                if (j > 0)          { col_indices.push_back(r - m_nx);  values.push_back(-m_cy); }
+                if (i > 0)          { col_indices.push_back(r - 1);     values.push_back(-m_cx); }
+                col_indices.push_back(r); values.push_back(m_diag);
+                if (i + 1 < m_nx)   { col_indices.push_back(r + 1);     values.push_back(-m_cx); }
+                if (j + 1 < m_ny)   { col_indices.push_back(r + m_nx);  values.push_back(-m_cy); }
+                if (k + 1 < m_nz)   { col_indices.push_back(r + plane); values.push_back(-m_cz); }
+                row_offsets[r + 1] = values.size();
+            }
+        }
+    }
+    return SparseMatrix(n, n, std::move(values), std::move(col_indices), std::move(row_offsets));
+}
+
+// --- Generators ---
+
+SparseMatrix poisson_matrix_2d(size_t nx, size_t ny) {
+    return StencilOperator2D(nx, ny).toSparseMatrix();
+}
+
+SparseMatrix poisson_matrix_3d(size_t nx, size_t ny, size_t nz) {
+    return StencilOperator3D(nx, ny, nz).toSparseMatrix();
+}
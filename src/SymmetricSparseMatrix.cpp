@@ -0,0 +1,213 @@
+// in file: src/SymmetricSparseMatrix.cpp
+#include "SymmetricSparseMatrix.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <utility> // For std::move
+#include <algorithm> // For std::max, std::min
+
+namespace {
+
+// Rows [row_begin, row_end) of the symmetric product. Updates of rows below
+// 'split' go to y, updates of rows >= split go to spill[j - split].
+// y must already hold zeros (or partial sums) for the rows it receives.
+void symmetric_rows(size_t row_begin, size_t row_end, size_t split,
+                    const size_t* row_offsets, const size_t* col_indices, const double* values,
+                    const double* x, double* y, double* spill) {
+    for (size_t i = row_begin; i < row_end; ++i) {
+        size_t k = row_offsets[i];
+        const size_t end = row_offsets[i + 1];
+        const double xi = x[i];
+        double sum = 0.0;
+        // Columns are sorted, so the diagonal (if stored) comes first
+        if (k < end && col_indices[k] == i) {
+            sum = values[k] * xi;
+            ++k;
+        }
+        for (; k < end; ++k) {
+            const size_t j = col_indices[k];
+            const double a = values[k];
+            sum += a * x[j];
+            if (j < split) {
+                y[j] += a * xi;
+            } else {
+                spill[j - split] += a * xi;
+            }
+        }
+        y[i] += sum;
+    }
+}
+
+} // namespace
+
+SymmetricSparseMatrix::SymmetricSparseMatrix(const SparseMatrix& A)
+    : m_upper(0, 0, 0) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Symmetric storage requires a square matrix");
+    }
+    const IndexArray& row_offsets = A.rowOffsets();
+    const IndexArray& col_indices = A.colIndices();
+    const DoubleArray& values = A.values();
+    const size_t n = A.rows();
+
+    std::vector<size_t> upper_offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        size_t count = 0;
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (col_indices[k] >= i) ++count;
+        }
+        upper_offsets[i + 1] = upper_offsets[i] + count;
+    }
+
+    // Each pool thread copies (and first touches) the upper rows it will multiply
+    DoubleArray u_values(upper_offsets[n]);
+    IndexArray u_cols(upper_offsets[n]);
+    IndexArray u_offsets(n + 1);
+    csr_row_blocks(n, upper_offsets.data(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t pos = upper_offsets[i];
+            u_offsets[i] = pos;
+            for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+                if (col_indices[k] >= i) {
+                    u_cols[pos] = col_indices[k];
+                    u_values[pos] = values[k];
+                    ++pos;
+                }
+            }
+        }
+    });
+    u_offsets[n] = upper_offsets[n];
+    m_upper = SparseMatrix(n, n, std::move(u_values), std::move(u_cols), std::move(u_offsets));
+}
+
+SymmetricSparseMatrix::SymmetricSparseMatrix(SparseMatrix&& upper, UpperTriangle)
+    : m_upper(std::move(upper)) {}
+
+SymmetricSparseMatrix SymmetricSparseMatrix::fromUpperTriangle(SparseMatrix&& upper) {
+    if (upper.rows() != upper.cols()) {
+        throw std::invalid_argument("Symmetric storage requires a square matrix");
+    }
+    const IndexArray& row_offsets = upper.rowOffsets();
+    const IndexArray& col_indices = upper.colIndices();
+    for (size_t i = 0; i < upper.rows(); ++i) {
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            if (col_indices[k] < i) {
+                throw std::invalid_argument("Upper-triangle matrix has an entry below the diagonal");
+            }
+        }
+    }
+    return SymmetricSparseMatrix(std::move(upper), UpperTriangle());
+}
+
+void SymmetricSparseMatrix::multiplySerial(const Vector& x, Vector& y) const {
+    const size_t n = rows();
+    if (x.size() != n || y.size() != n) {
+        throw std::length_error("Matrix and Vector sizes must match");
+    }
+    double* py = y.data();
+    for (size_t i = 0; i < n; ++i) py[i] = 0.0;
+    symmetric_rows(0, n, n, m_upper.rowOffsets().data(), m_upper.colIndices().data(),
+                   m_upper.values().data(), x.data(), py, nullptr);
+}
+
+// Thread-local accumulation in two passes:
+//  1. thread t zeroes and fills y on its own rows [begin_t, end_t); updates of
+//     later rows go to its buffer, which spans [end_t, reach_t) where reach_t
+//     is one past the largest column of its rows
+//  2. thread t adds the buffers of the earlier threads that reach into its rows
+void SymmetricSparseMatrix::multiply(const Vector& x, Vector& y) const {
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() == 1 || nnz() < kParallelMinWork) {
+        multiplySerial(x, y);
+        return;
+    }
+    const size_t n = rows();
+    if (x.size() != n || y.size() != n) {
+        throw std::length_error("Matrix and Vector sizes must match");
+    }
+
+    const size_t* row_offsets = m_upper.rowOffsets().data();
+    const size_t* col_indices = m_upper.colIndices().data();
+    const double* values = m_upper.values().data();
+    const double* px = x.data();
+    double* py = y.data();
+
+    const std::vector<size_t> bounds = m_upper.rowPartition(pool.size());
+    const size_t num_blocks = bounds.size() - 1;
+    std::vector<DoubleArray> spill(num_blocks);
+    std::vector<size_t> reach(num_blocks, 0);
+
+    pool.run([&](size_t tid, size_t num_threads) {
+        for (size_t b = tid; b < num_blocks; b += num_threads) {
+            const size_t begin = bounds[b];
+            const size_t end = bounds[b + 1];
+            size_t last = end;
+            for (size_t i = begin; i < end; ++i) {
+                if (row_offsets[i + 1] > row_offsets[i]) {
+                    const size_t max_col = col_indices[row_offsets[i + 1] - 1] + 1;
+                    if (max_col > last) last = max_col;
+                }
+            }
+            reach[b] = last;
+            spill[b].assign(last - end, 0.0);
+            for (size_t i = begin; i < end; ++i) py[i] = 0.0;
+            symmetric_rows(begin, end, end, row_offsets, col_indices, values, px, py, spill[b].data());
+        }
+    });
+
+    pool.run([&](size_t tid, size_t num_threads) {
+        for (size_t b = tid; b < num_blocks; b += num_threads) {
+            const size_t begin = bounds[b];
+            const size_t end = bounds[b + 1];
+            for (size_t s = 0; s < b; ++s) {
+                const size_t from = std::max(begin, bounds[s + 1]);
+                const size_t to = std::min(end, reach[s]);
+                if (to <= from) continue;
+                const double* buffer = spill[s].data() - bounds[s + 1];
+                for (size_t i = from; i < to; ++i) py[i] += buffer[i];
+            }
+        }
+    });
+}
+
+Vector SymmetricSparseMatrix::operator*(const Vector& x) const {
+    Vector result(rows());
+    multiply(x, result);
+    return result;
+}
+
+SparseMatrix SymmetricSparseMatrix::toSparseMatrix() const {
+    const size_t n = rows();
+    const IndexArray& row_offsets = m_upper.rowOffsets();
+    const IndexArray& col_indices = m_upper.colIndices();
+    const DoubleArray& values = m_upper.values();
+
+    // Row i of the full matrix: the mirrored entries (columns < i), then row i of the upper part
+    IndexArray f_offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            f_offsets[i + 1]++;
+            if (col_indices[k] != i) f_offsets[col_indices[k] + 1]++;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) f_offsets[i + 1] += f_offsets[i];
+
+    IndexArray f_cols(f_offsets[n]);
+    DoubleArray f_values(f_offsets[n]);
+    std::vector<size_t> next(f_offsets.begin(), f_offsets.end() - 1);
+    // Visiting rows in order emits the mirrored entries of row j in increasing column order,
+    // and they all precede the upper part of row j
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            const size_t j = col_indices[k];
+            size_t pos = next[i]++;
+            f_cols[pos] = j;
+            f_values[pos] = values[k];
+            if (j != i) {
+                pos = next[j]++;
+                f_cols[pos] = i;
+                f_values[pos] = values[k];
+            }
+        }
+    }
+    return SparseMatrix(n, n, std::move(f_values), std::move(f_cols), std::move(f_offsets));
+}
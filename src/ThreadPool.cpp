@@ -0,0 +1,176 @@
+// in file: src/ThreadPool.cpp
+#include "ThreadPool.hpp"
+#include <stdexcept>
+
+namespace {
+// True while the current thread is executing a pool task.
+// Used to run nested run() calls serially instead of deadlocking.
+thread_local bool t_inside_pool = false;
+}
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : m_num_threads(1), m_task(nullptr), m_generation(0), m_pending(0), m_stop(false) {
+    startWorkers(num_threads);
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+size_t ThreadPool::size() const {
+    return m_num_threads;
+}
+
+void ThreadPool::resize(size_t num_threads) {
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads == m_num_threads) {
+        return;
+    }
+    stopWorkers();
+    startWorkers(num_threads);
+}
+
+// Thread 0 is always the caller of run(), so only num_threads - 1 workers are spawned
+void ThreadPool::startWorkers(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    m_stop = false;
+    m_num_threads = num_threads;
+    for (size_t t = 1; t < num_threads; ++t) {
+        m_workers.push_back(std::thread(&ThreadPool::workerLoop, this, t, m_generation));
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t t = 0; t < m_workers.size(); ++t) {
+        m_workers[t].join();
+    }
+    m_workers.clear();
+    m_num_threads = 1;
+}
+
+// start_generation is taken when the worker is spawned, so a task published
+// before the thread gets scheduled is still picked up
+void ThreadPool::workerLoop(size_t thread_id, size_t start_generation) {
+    t_inside_pool = true;
+    size_t seen_generation = start_generation;
+
+    while (true) {
+        const std::function<void(size_t, size_t)>* task = nullptr;
+        size_t num_threads = 0;
+        {
+            // Sleep until a new task is published or the pool shuts down
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop && m_generation == seen_generation) {
+                m_wake.wait(lock);
+            }
+            if (m_stop) {
+                return;
+            }
+            seen_generation = m_generation;
+            task = m_task;
+            num_threads = m_num_threads;
+        }
+
+        std::exception_ptr error;
+        try {
+            (*task)(thread_id, num_threads);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (error && !m_error) {
+                m_error = error;
+            }
+            if (--m_pending == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::run(const std::function<void(size_t, size_t)>& fn) {
+    // Nested call, or nothing to share: the whole job runs as a single thread
+    if (t_inside_pool || m_num_threads == 1) {
+        fn(0, 1);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+    const size_t num_threads = m_num_threads;
+
+    // Publish the task to the workers
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &fn;
+        m_pending = num_threads - 1;
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    // The caller does its own share as thread 0
+    std::exception_ptr error;
+    t_inside_pool = true;
+    try {
+        fn(0, num_threads);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    t_inside_pool = false;
+
+    // Wait for the workers to finish
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_pending != 0) {
+            m_done.wait(lock);
+        }
+        m_task = nullptr;
+        if (!error) {
+            error = m_error;
+        }
+        m_error = nullptr;
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+SerialKernelScope::SerialKernelScope() : m_previous(t_inside_pool) {
+    t_inside_pool = true;
+}
+
+SerialKernelScope::~SerialKernelScope() {
+    t_inside_pool = m_previous;
+}
+
+ThreadPool& ThreadPool::global() {
+    // Created on first use; starts serial until set_num_threads() is called
+    static ThreadPool pool(1);
+    return pool;
+}
+
+void set_num_threads(size_t num_threads) {
+    ThreadPool::global().resize(num_threads);
+}
+
+size_t get_num_threads() {
+    return ThreadPool::global().size();
+}
+
+size_t parallel_block_count(size_t work, size_t min_work) {
+    ThreadPool& pool = ThreadPool::global();
+    return (pool.size() == 1 || work < min_work) ? 1 : pool.size();
+}
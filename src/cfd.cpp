@@ -1,9 +1,16 @@
 #include "cfd.hpp"
 #include "SparseMatrix.hpp"
+#include "LinearOperator.hpp"
+#include "Preconditioner.hpp"
 #include "vector.hpp"
+#include "ThreadPool.hpp"
+#include "Timing.hpp"
 #include <iostream>
 #include <cmath>
+#include <stdexcept>
 #include <numeric> // For std::inner_product (or you can use a loop for dot product)
+#include <ostream>
+#include <algorithm> // For std::fill, std::min, std::max
 
 // The function's actual definition/implementation.
 void hello_cfd() {
@@ -17,9 +24,13 @@ double dot_product(const Vector& a, const Vector& b) {
         throw std::length_error("Vectors must be same size for dot product.");
     }
     
+    // Raw pointers: the bounds check in operator[] is not needed here
+    const double* pa = a.data();
+    const double* pb = b.data();
+    const size_t n = a.size();
     double result = 0.0;
-    for (size_t i = 0; i < a.size(); ++i) {
-        result += a[i] * b[i];
+    for (size_t i = 0; i < n; ++i) {
+        result += pa[i] * pb[i];
     }
     return result;
 }
@@ -30,72 +41,801 @@ double norm(const Vector& a) {
 }
 
 
+// --- Solve reports and monitors ---
+
+const char* to_string(ConvergenceReason reason) {
+    switch (reason) {
+        case ConvergenceReason::Converged:        return "converged";
+        case ConvergenceReason::MaxIterations:    return "maximum iterations reached";
+        case ConvergenceReason::StoppedByMonitor: return "stopped by monitor";
+        case ConvergenceReason::Breakdown:        return "breakdown";
+    }
+    return "unknown";
+}
+
+std::ostream& operator<<(std::ostream& out, const SolveReport& report) {
+    out << "Solver " << to_string(report.reason) << " after " << report.iterations
+        << " iterations. Residual norm: " << report.initial_residual
+        << " -> " << report.final_residual << "\n";
+    out << "Time: " << report.time_total << " s (SpMV " << report.time_spmv
+        << " s, dot products " << report.time_dot
+        << " s, vector updates " << report.time_update
+        << " s, preconditioner " << report.time_preconditioner << " s)\n";
+    return out;
+}
+
+PrintingMonitor::PrintingMonitor(std::ostream& out, size_t every)
+    : m_out(out), m_every(every == 0 ? 1 : every) {}
+
+bool PrintingMonitor::onIteration(const IterationState& state) {
+    if (state.iteration % m_every == 0) {
+        // '\n' instead of std::endl: no flush per iteration
+        m_out << "Iteration " << state.iteration << ": Residual norm = " << state.residual_norm << '\n';
+    }
+    return true;
+}
+
+
 // --- Conjugate Gradient Solver Implementation ---
-Vector solve_cg(const SparseMatrix& A, const Vector& b, const Vector& x0, 
-                size_t max_iter, double tolerance) {
-    
-    // 1. Initialization (Guess is our starting point)
-    Vector x = x0; 
-    
+// Written as a template over the operator type and over whether the solve is
+// instrumented; the public entry points below instantiate it for LinearOperator.
+namespace {
+
+// Fills a SolveReport and forwards iterations to the monitor.
+// SolveRecorder<false> does nothing at all, so the plain solve_cg / solve_pcg
+// overloads compile to the bare loop: no clock reads, no history, no calls.
+template <bool Enabled>
+class SolveRecorder;
+
+template <>
+class SolveRecorder<false> {
+public:
+    SolveRecorder() {}
+    void start() {}
+    void stop(double SolveReport::*) {}
+    void residual(double) {}
+    void coefficients(double, double) {}
+    bool notify(size_t, double, double, const Vector&, const Vector&) { return true; }
+    void finish(size_t, ConvergenceReason) {}
+};
+
+template <>
+class SolveRecorder<true> {
+public:
+    SolveRecorder(SolveReport& report, SolveMonitor* monitor)
+        : m_report(report), m_monitor(monitor), m_begin(Clock::now()) {
+        m_report = SolveReport();
+    }
+
+    // Times the phase between start() and stop(&SolveReport::time_...)
+    void start() { m_start = Clock::now(); }
+    void stop(double SolveReport::* phase) {
+        m_report.*phase += seconds_since(m_start);
+    }
+
+    void residual(double r_norm) { m_report.residual_history.push_back(r_norm); }
+
+    // CG step length and direction update of one iteration (Lanczos coefficients)
+    void coefficients(double alpha, double beta) {
+        m_report.cg_alpha.push_back(alpha);
+        m_report.cg_beta.push_back(beta);
+    }
+
+    // Returns false if the monitor wants to stop
+    bool notify(size_t iteration, double r_norm, double b_norm, const Vector& x, const Vector& r) {
+        if (!m_monitor) {
+            return true;
+        }
+        IterationState state = { iteration, r_norm, b_norm > 0.0 ? r_norm / b_norm : r_norm, x, r };
+        return m_monitor->onIteration(state);
+    }
+
+    void finish(size_t iterations, ConvergenceReason reason) {
+        m_report.iterations = iterations;
+        m_report.reason = reason;
+        if (!m_report.residual_history.empty()) {
+            m_report.initial_residual = m_report.residual_history.front();
+            m_report.final_residual = m_report.residual_history.back();
+        }
+        m_report.time_total = seconds_since(m_begin);
+    }
+
+private:
+    SolveReport& m_report;
+    SolveMonitor* m_monitor;
+    Clock::time_point m_begin;
+    Clock::time_point m_start;
+};
+
+template <bool Instrumented, class Matrix>
+size_t conjugate_gradient(const Matrix& A, const Vector& b, Vector& x,
+                          size_t max_iter, double tolerance, CGWorkspace& ws,
+                          SolveRecorder<Instrumented>& rec) {
+    if (A.rows() != b.size() || A.cols() != x.size()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+
+    // Only allocates the first time (or when the problem size changes)
+    ws.resize(b.size());
+    Vector& r = ws.r;
+    Vector& p = ws.p;
+    Vector& Ap = ws.Ap;
+
+    // 1. Initialization
     // r = b - A * x (Residual: How far off our guess is)
-    Vector r = b - (A * x); 
-    
-    // p = r (Initial search direction is the residual)
-    Vector p = r; 
+    rec.start();
+    A.multiply(x, r);
+    rec.stop(&SolveReport::time_spmv);
+    rec.start();
+    r.xpay(b, -1.0);
 
-    // Initial check on the error (residual norm)
-    double r_norm = norm(r);
+    // p = r (Initial search direction is the residual)
+    p.copyFrom(r);
+    rec.stop(&SolveReport::time_update);
 
-    std::cout << "CG Solver started. Initial residual norm: " << r_norm << std::endl;
-    
     // r_old_dot_r_old = r · r (The numerator for alpha and beta)
+    // Base residual norm ||b|| for the relative tolerance check
+    rec.start();
     double r_old_dot_r_old = dot_product(r, r);
-    
-    // Base residual norm for relative tolerance check
     double b_norm = norm(b);
+    rec.stop(&SolveReport::time_dot);
+    double r_norm = std::sqrt(r_old_dot_r_old);
+    rec.residual(r_norm);
 
     // 2. Iterative Loop
-    for (size_t k = 0; k < max_iter; ++k) {
-        
+    size_t k = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    for (; k < max_iter; ++k) {
+
         // Check for convergence based on tolerance
-        if (r_norm < tolerance * b_norm) {
-            std::cout << "CG converged in " << k << " iterations. Final residual norm: " << r_norm << std::endl;
-            return x;
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
         }
 
         // a) Ap = A * p (Matrix-Vector product with the search direction)
-        Vector Ap = A * p;
+        rec.start();
+        A.multiply(p, Ap);
+        rec.stop(&SolveReport::time_spmv);
 
         // b) Calculate alpha (The optimal step size along direction p)
         // alpha = (r_old · r_old) / (p · Ap)
-        double alpha = r_old_dot_r_old / dot_product(p, Ap);
-
-        // c) Update solution: x = x + alpha * p
-        // Note: alpha * p requires the Vector::operator* (scalar multiplication)
-        x = x + (p * alpha); 
-
-        // d) Update residual: r_new = r_old - alpha * Ap
-        Vector r_new = r - (Ap * alpha);
-        
-        // e) Calculate new residual norm for convergence check
-        r_norm = norm(r_new);
-        std::cout << "Iteration " << k + 1 << ": Residual norm = " << r_norm << std::endl;
-        
+        rec.start();
+        double p_dot_Ap = dot_product(p, Ap);
+        rec.stop(&SolveReport::time_dot);
+        if (!(p_dot_Ap > 0.0) || !std::isfinite(p_dot_Ap)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        double alpha = r_old_dot_r_old / p_dot_Ap;
+
+        // c) Update solution in place: x += alpha * p
+        rec.start();
+        x.axpy(alpha, p);
+
+        // d) Update residual in place and get r_new · r_new in the same pass:
+        // r -= alpha * Ap
+        double r_new_dot_r_new = r.axpyDot(-alpha, Ap);
+
+        // e) New residual norm for the convergence check
+        r_norm = std::sqrt(r_new_dot_r_new);
+
         // f) Calculate beta (The factor to define the next search direction)
         // beta = (r_new · r_new) / (r_old · r_old)
-        double r_new_dot_r_new = dot_product(r_new, r_new);
         double beta = r_new_dot_r_new / r_old_dot_r_old;
 
-        // g) Update search direction: p_new = r_new + beta * p_old
-        // Note: beta * p_old requires the Vector::operator* (scalar multiplication)
-        p = r_new + (p * beta);
+        // g) Update search direction in place: p = r_new + beta * p_old
+        p.xpay(r, beta);
+        rec.stop(&SolveReport::time_update);
 
         // h) Prepare for next iteration
-        r = r_new; // r_new becomes r_old for the next iteration
         r_old_dot_r_old = r_new_dot_r_new;
+
+        rec.coefficients(alpha, beta);
+        rec.residual(r_norm);
+        if (!rec.notify(k + 1, r_norm, b_norm, x, r)) {
+            reason = ConvergenceReason::StoppedByMonitor;
+            ++k;
+            break;
+        }
     }
-    
-    // If loop finished without converging
-    std::cout << "CG FAILED to converge in max_iter (" << max_iter << ") iterations. Final residual norm: " << r_norm << std::endl;
+
+    // The last iteration may have reached the tolerance
+    if (reason == ConvergenceReason::MaxIterations && r_norm <= tolerance * b_norm) {
+        reason = ConvergenceReason::Converged;
+    }
+    rec.finish(k, reason);
+    return k;
+}
+
+// --- Preconditioned Conjugate Gradient ---
+// Same structure as above, with z = M^-1 r used for the search directions.
+template <bool Instrumented, class Matrix>
+size_t preconditioned_conjugate_gradient(const Matrix& A, const Vector& b, Vector& x,
+                                         const Preconditioner& M,
+                                         size_t max_iter, double tolerance, CGWorkspace& ws,
+                                         SolveRecorder<Instrumented>& rec) {
+    if (A.rows() != b.size() || A.cols() != x.size()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+
+    ws.resize(b.size());
+    Vector& r = ws.r;
+    Vector& z = ws.z;
+    Vector& p = ws.p;
+    Vector& Ap = ws.Ap;
+
+    // 1. Initialization: r = b - A * x, z = M^-1 r, p = z
+    rec.start();
+    A.multiply(x, r);
+    rec.stop(&SolveReport::time_spmv);
+    rec.start();
+    r.xpay(b, -1.0);
+    rec.stop(&SolveReport::time_update);
+    rec.start();
+    M.apply(r, z);
+    rec.stop(&SolveReport::time_preconditioner);
+    rec.start();
+    p.copyFrom(z);
+    rec.stop(&SolveReport::time_update);
+
+    // r · z replaces r · r in alpha and beta
+    rec.start();
+    double r_dot_z = dot_product(r, z);
+    double r_norm = norm(r);
+    double b_norm = norm(b);
+    rec.stop(&SolveReport::time_dot);
+    rec.residual(r_norm);
+
+    // 2. Iterative Loop
+    size_t k = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    for (; k < max_iter; ++k) {
+
+        // Convergence is still judged on the true residual norm ||r||
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
+        }
+
+        // a) Ap = A * p
+        rec.start();
+        A.multiply(p, Ap);
+        rec.stop(&SolveReport::time_spmv);
+
+        // b) alpha = (r · z) / (p · Ap)
+        rec.start();
+        double p_dot_Ap = dot_product(p, Ap);
+        rec.stop(&SolveReport::time_dot);
+        if (!(p_dot_Ap > 0.0) || !std::isfinite(p_dot_Ap)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+        double alpha = r_dot_z / p_dot_Ap;
+
+        // c) x += alpha * p
+        // d) r -= alpha * Ap, with r · r from the same pass
+        rec.start();
+        x.axpy(alpha, p);
+        r_norm = std::sqrt(r.axpyDot(-alpha, Ap));
+        rec.stop(&SolveReport::time_update);
+
+        // e) Apply the preconditioner: z = M^-1 r
+        rec.start();
+        M.apply(r, z);
+        rec.stop(&SolveReport::time_preconditioner);
+
+        // f) beta = (r_new · z_new) / (r_old · z_old)
+        rec.start();
+        double r_dot_z_new = dot_product(r, z);
+        rec.stop(&SolveReport::time_dot);
+        double beta = r_dot_z_new / r_dot_z;
+
+        // g) p = z + beta * p
+        rec.start();
+        p.xpay(z, beta);
+        rec.stop(&SolveReport::time_update);
+
+        r_dot_z = r_dot_z_new;
+
+        rec.coefficients(alpha, beta);
+        rec.residual(r_norm);
+        if (!rec.notify(k + 1, r_norm, b_norm, x, r)) {
+            reason = ConvergenceReason::StoppedByMonitor;
+            ++k;
+            break;
+        }
+    }
+
+    if (reason == ConvergenceReason::MaxIterations && r_norm <= tolerance * b_norm) {
+        reason = ConvergenceReason::Converged;
+    }
+    rec.finish(k, reason);
+    return k;
+}
+
+// --- CG variants: threaded vector passes ---
+
+void fill_zero(Vector& v) {
+    double* p = v.data();
+    for (size_t i = 0; i < v.size(); ++i) {
+        p[i] = 0.0;
+    }
+}
+
+// --- Pipelined CG (Ghysels & Vanroose, 2014) ---
+// Besides r and p it carries w = A r, s = A p, z = A s, so that every vector
+// update is a recurrence and the dot products (r, r) and (w, r) can be
+// computed in the same pass. The only SpMV per iteration, q = A w, does not
+// depend on that reduction, so in a distributed run the two overlap.
+template <bool Instrumented>
+size_t pipelined_conjugate_gradient(const LinearOperator& A, const Vector& b, Vector& x,
+                                    size_t max_iter, double tolerance, size_t replace_every,
+                                    CGWorkspace& ws, SolveRecorder<Instrumented>& rec) {
+    if (A.rows() != b.size() || A.cols() != x.size()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+
+    const size_t n = b.size();
+    ws.resize(n);
+    ws.w.resize(n);
+    ws.q.resize(n);
+    Vector& r = ws.r;
+    Vector& w = ws.w;
+    Vector& q = ws.q;
+    Vector& p = ws.p;
+    Vector& s = ws.Ap; // A p
+    Vector& z = ws.z;  // A s
+
+    const size_t blocks = parallel_block_count(n);
+    std::vector<double> partial(2 * blocks);
+    double gamma = 0.0; // (r, r)
+    double delta = 0.0; // (w, r)
+
+    // r = b - A x and w = A r; with_directions also rebuilds s = A p and z = A s
+    auto recompute = [&](bool with_directions) {
+        rec.start();
+        A.multiply(x, r);
+        rec.stop(&SolveReport::time_spmv);
+        rec.start();
+        r.xpay(b, -1.0);
+        rec.stop(&SolveReport::time_update);
+        rec.start();
+        A.multiply(r, w);
+        if (with_directions) {
+            A.multiply(p, s);
+            A.multiply(s, z);
+        }
+        rec.stop(&SolveReport::time_spmv);
+
+        rec.start();
+        const double* pr = r.data();
+        const double* pw = w.data();
+        std::fill(partial.begin(), partial.end(), 0.0);
+        parallel_blocks(n, blocks, [&](size_t begin, size_t end, size_t block) {
+            double g = 0.0, d = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                g += pr[i] * pr[i];
+                d += pw[i] * pr[i];
+            }
+            partial[2 * block] = g;
+            partial[2 * block + 1] = d;
+        });
+        gamma = 0.0;
+        delta = 0.0;
+        for (size_t t = 0; t < blocks; ++t) {
+            gamma += partial[2 * t];
+            delta += partial[2 * t + 1];
+        }
+        rec.stop(&SolveReport::time_dot);
+    };
+
+    // 1. Initialization: p = s = z = 0 so that the first iteration (beta = 0) starts from r
+    fill_zero(p);
+    fill_zero(s);
+    fill_zero(z);
+    recompute(false);
+    rec.start();
+    double b_norm = norm(b);
+    rec.stop(&SolveReport::time_dot);
+    double r_norm = std::sqrt(gamma);
+    rec.residual(r_norm);
+
+    double gamma_old = 0.0;
+    double alpha_old = 0.0;
+
+    // 2. Iterative Loop
+    size_t k = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    for (; k < max_iter; ++k) {
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
+        }
+
+        // a) q = A w (overlaps the reduction of gamma and delta)
+        rec.start();
+        A.multiply(w, q);
+        rec.stop(&SolveReport::time_spmv);
+
+        // b) Scalars: beta = gamma / gamma_old, alpha = gamma / (delta - beta * gamma / alpha_old)
+        double beta = 0.0;
+        double alpha = gamma / delta;
+        if (k > 0) {
+            beta = gamma / gamma_old;
+            alpha = gamma / (delta - beta * gamma / alpha_old);
+        }
+        if (!(alpha > 0.0) || !std::isfinite(alpha)) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+
+        // c) One fused pass: all six recurrences, plus the next (r, r) and (w, r)
+        rec.start();
+        double* px = x.data();
+        double* pr = r.data();
+        double* pw = w.data();
+        double* pp = p.data();
+        double* ps = s.data();
+        double* pz = z.data();
+        const double* pq = q.data();
+        std::fill(partial.begin(), partial.end(), 0.0);
+        parallel_blocks(n, blocks, [&](size_t begin, size_t end, size_t block) {
+            double g = 0.0, d = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                double zi = pq[i] + beta * pz[i];
+                double si = pw[i] + beta * ps[i];
+                double pi = pr[i] + beta * pp[i];
+                px[i] += alpha * pi;
+                double ri = pr[i] - alpha * si;
+                double wi = pw[i] - alpha * zi;
+                pz[i] = zi;
+                ps[i] = si;
+                pp[i] = pi;
+                pr[i] = ri;
+                pw[i] = wi;
+                g += ri * ri;
+                d += wi * ri;
+            }
+            partial[2 * block] = g;
+            partial[2 * block + 1] = d;
+        });
+        gamma_old = gamma;
+        alpha_old = alpha;
+        gamma = 0.0;
+        delta = 0.0;
+        for (size_t t = 0; t < blocks; ++t) {
+            gamma += partial[2 * t];
+            delta += partial[2 * t + 1];
+        }
+        rec.stop(&SolveReport::time_update);
+
+        // d) Residual replacement: the recurrences drift from b - A x in finite precision
+        if (replace_every > 0 && (k + 1) % replace_every == 0) {
+            recompute(true);
+        }
+
+        r_norm = std::sqrt(gamma);
+        rec.residual(r_norm);
+        if (!rec.notify(k + 1, r_norm, b_norm, x, r)) {
+            reason = ConvergenceReason::StoppedByMonitor;
+            ++k;
+            break;
+        }
+    }
+
+    if (reason == ConvergenceReason::MaxIterations && r_norm <= tolerance * b_norm) {
+        reason = ConvergenceReason::Converged;
+    }
+    rec.finish(k, reason);
+    return k;
+}
+
+// --- s-step CG (Chronopoulos & Gear, 1989; Carson & Demmel, 2014) ---
+// Every outer step builds V = [P_0..P_s, R_0..R_{s-1}] with P_j = (A/theta)^j p
+// and R_j = (A/theta)^j r, computes the Gram matrix G = V^T V in a single
+// reduction, and runs s CG iterations on coordinate vectors c (x = V c),
+// where dot products become c1^T G c2 and A V c becomes V (T c) with T a
+// shift matrix. The vectors are recovered with one more pass at the end.
+// theta ~ ||A r|| / ||r|| keeps the monomial basis columns of similar size.
+template <bool Instrumented>
+size_t s_step_conjugate_gradient(const LinearOperator& A, const Vector& b, Vector& x,
+                                 size_t max_iter, double tolerance, size_t s, size_t replace_every,
+                                 CGWorkspace& ws, SolveRecorder<Instrumented>& rec) {
+    if (A.rows() != b.size() || A.cols() != x.size()) {
+        throw std::length_error("Matrix, right-hand side and solution sizes must match.");
+    }
+    if (s == 0) {
+        throw std::invalid_argument("s-step CG needs s >= 1");
+    }
+
+    const size_t n = b.size();
+    const size_t m = 2 * s + 1; // basis size
+    ws.resize(n);
+    ws.basis.resize(m);
+    for (size_t c = 0; c < m; ++c) {
+        ws.basis[c].resize(n);
+    }
+    Vector& r = ws.r;
+    Vector& p = ws.p;
+    std::vector<Vector>& V = ws.basis;
+
+    // 1. Initialization: r = b - A x, p = r
+    rec.start();
+    A.multiply(x, r);
+    rec.stop(&SolveReport::time_spmv);
+    rec.start();
+    r.xpay(b, -1.0);
+    p.copyFrom(r);
+    rec.stop(&SolveReport::time_update);
+    rec.start();
+    double b_norm = norm(b);
+    double r_norm = norm(r);
+    rec.stop(&SolveReport::time_dot);
+    rec.residual(r_norm);
+
+    rec.start();
+    A.multiply(r, ws.Ap);
+    rec.stop(&SolveReport::time_spmv);
+    double theta = r_norm > 0.0 ? norm(ws.Ap) / r_norm : 1.0;
+    if (!(theta > 0.0) || !std::isfinite(theta)) {
+        theta = 1.0;
+    }
+    const double inv_theta = 1.0 / theta;
+
+    const size_t blocks = parallel_block_count(n);
+    std::vector<double> G(m * m);
+    std::vector<double> partial_G(blocks * m * m);
+    std::vector<double> partial_rr(blocks);
+    std::vector<const double*> cols(m);
+    std::vector<double> pc(m), rc(m), xc(m), apc(m), Gv(m);
+
+    // c1^T G c2
+    auto g_dot = [&](const std::vector<double>& c1, const std::vector<double>& c2) {
+        for (size_t a = 0; a < m; ++a) {
+            double sum = 0.0;
+            for (size_t c = 0; c < m; ++c) sum += G[a * m + c] * c2[c];
+            Gv[a] = sum;
+        }
+        double result = 0.0;
+        for (size_t a = 0; a < m; ++a) result += c1[a] * Gv[a];
+        return result;
+    };
+
+    size_t k = 0;
+    size_t last_replacement = 0;
+    ConvergenceReason reason = ConvergenceReason::MaxIterations;
+    while (true) {
+        if (r_norm <= tolerance * b_norm) {
+            reason = ConvergenceReason::Converged;
+            break;
+        }
+        if (k >= max_iter) {
+            break;
+        }
+
+        // 2. Krylov basis (2s SpMVs; a matrix-powers kernel would do them with one halo exchange)
+        rec.start();
+        V[0].copyFrom(p);
+        V[s + 1].copyFrom(r);
+        rec.stop(&SolveReport::time_update);
+        for (size_t j = 0; j < s; ++j) {
+            rec.start();
+            A.multiply(V[j], V[j + 1]);
+            if (j + 1 < s) A.multiply(V[s + 1 + j], V[s + 2 + j]);
+            rec.stop(&SolveReport::time_spmv);
+            rec.start();
+            V[j + 1].scale(inv_theta);
+            if (j + 1 < s) V[s + 2 + j].scale(inv_theta);
+            rec.stop(&SolveReport::time_update);
+        }
+
+        // 3. Gram matrix: the one reduction of this block, in row chunks that stay in cache
+        rec.start();
+        for (size_t c = 0; c < m; ++c) cols[c] = V[c].data();
+        std::fill(partial_G.begin(), partial_G.end(), 0.0);
+        parallel_blocks(n, blocks, [&](size_t begin, size_t end, size_t block) {
+            double* g = &partial_G[block * m * m];
+            const size_t kChunk = 512;
+            for (size_t i0 = begin; i0 < end; i0 += kChunk) {
+                size_t i1 = std::min(end, i0 + kChunk);
+                for (size_t a = 0; a < m; ++a) {
+                    const double* va = cols[a];
+                    for (size_t c = a; c < m; ++c) {
+                        const double* vc = cols[c];
+                        double sum = 0.0;
+                        for (size_t i = i0; i < i1; ++i) sum += va[i] * vc[i];
+                        g[a * m + c] += sum;
+                    }
+                }
+            }
+        });
+        std::fill(G.begin(), G.end(), 0.0);
+        for (size_t t = 0; t < blocks; ++t) {
+            for (size_t a = 0; a < m; ++a) {
+                for (size_t c = a; c < m; ++c) G[a * m + c] += partial_G[t * m * m + a * m + c];
+            }
+        }
+        for (size_t a = 0; a < m; ++a) {
+            for (size_t c = 0; c < a; ++c) G[a * m + c] = G[c * m + a];
+        }
+        rec.stop(&SolveReport::time_dot);
+
+        // 4. s CG iterations on the coordinates (p = e_0, r = e_{s+1}, x = 0)
+        std::fill(pc.begin(), pc.end(), 0.0);
+        std::fill(rc.begin(), rc.end(), 0.0);
+        std::fill(xc.begin(), xc.end(), 0.0);
+        pc[0] = 1.0;
+        rc[s + 1] = 1.0;
+        double rr = g_dot(rc, rc);
+        bool breakdown = false;
+        for (size_t j = 0; j < s && k < max_iter; ++j) {
+            // (A V c) = V (T c): T moves each block's coefficients one column up, times theta
+            std::fill(apc.begin(), apc.end(), 0.0);
+            for (size_t c = 0; c < s; ++c) apc[c + 1] = theta * pc[c];
+            for (size_t c = 0; c + 1 < s; ++c) apc[s + 2 + c] = theta * pc[s + 1 + c];
+
+            double p_dot_Ap = g_dot(pc, apc);
+            if (!(p_dot_Ap > 0.0) || !std::isfinite(p_dot_Ap)) {
+                breakdown = true;
+                break;
+            }
+            double alpha = rr / p_dot_Ap;
+            for (size_t c = 0; c < m; ++c) {
+                xc[c] += alpha * pc[c];
+                rc[c] -= alpha * apc[c];
+            }
+            double rr_new = g_dot(rc, rc);
+            double beta = rr_new / rr;
+            for (size_t c = 0; c < m; ++c) pc[c] = rc[c] + beta * pc[c];
+            rr = rr_new;
+            ++k;
+
+            double r_estimate = std::sqrt(std::max(rr, 0.0));
+            rec.residual(r_estimate);
+            if (r_estimate <= tolerance * b_norm) {
+                break;
+            }
+        }
+
+        // 5. Recover x += V xc, r = V rc, p = V pc, with ||r||^2 from the same pass
+        rec.start();
+        double* px = x.data();
+        double* pr = r.data();
+        double* pp = p.data();
+        std::fill(partial_rr.begin(), partial_rr.end(), 0.0);
+        parallel_blocks(n, blocks, [&](size_t begin, size_t end, size_t block) {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                double xi = 0.0, ri = 0.0, pi = 0.0;
+                for (size_t c = 0; c < m; ++c) {
+                    double v = cols[c][i];
+                    xi += xc[c] * v;
+                    ri += rc[c] * v;
+                    pi += pc[c] * v;
+                }
+                px[i] += xi;
+                pr[i] = ri;
+                pp[i] = pi;
+                sum += ri * ri;
+            }
+            partial_rr[block] = sum;
+        });
+        double rr_true = 0.0;
+        for (size_t t = 0; t < blocks; ++t) rr_true += partial_rr[t];
+        r_norm = std::sqrt(rr_true);
+        rec.stop(&SolveReport::time_update);
+
+        if (breakdown) {
+            reason = ConvergenceReason::Breakdown;
+            break;
+        }
+
+        // 6. Residual replacement at block boundaries
+        if (replace_every > 0 && k / replace_every > last_replacement) {
+            last_replacement = k / replace_every;
+            rec.start();
+            A.multiply(x, r);
+            rec.stop(&SolveReport::time_spmv);
+            rec.start();
+            r.xpay(b, -1.0);
+            rec.stop(&SolveReport::time_update);
+            rec.start();
+            r_norm = norm(r);
+            rec.stop(&SolveReport::time_dot);
+        }
+
+        if (!rec.notify(k, r_norm, b_norm, x, r)) {
+            reason = ConvergenceReason::StoppedByMonitor;
+            break;
+        }
+    }
+
+    rec.finish(k, reason);
+    return k;
+}
+
+template <bool Instrumented>
+size_t run_cg_variant(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                      CGWorkspace& ws, const CGVariantOptions& options, SolveRecorder<Instrumented>& rec) {
+    switch (options.variant) {
+        case CGVariant::Pipelined:
+            return pipelined_conjugate_gradient(A, b, x, max_iter, tolerance,
+                                                options.residual_replacement, ws, rec);
+        case CGVariant::SStep:
+            return s_step_conjugate_gradient(A, b, x, max_iter, tolerance, options.s,
+                                             options.residual_replacement, ws, rec);
+        case CGVariant::Classic:
+        default:
+            return conjugate_gradient(A, b, x, max_iter, tolerance, ws, rec);
+    }
+}
+
+} // namespace
+
+void CGWorkspace::resize(size_t n) {
+    r.resize(n);
+    z.resize(n);
+    p.resize(n);
+    Ap.resize(n);
+}
+
+Vector solve_cg(const LinearOperator& A, const Vector& b, const Vector& x0,
+                size_t max_iter, double tolerance) {
+    Vector x = x0;
+    CGWorkspace ws;
+    SolveRecorder<false> rec;
+    conjugate_gradient(A, b, x, max_iter, tolerance, ws, rec);
+    return x;
+}
+
+size_t solve_cg(const LinearOperator& A, const Vector& b, Vector& x,
+                size_t max_iter, double tolerance, CGWorkspace& workspace) {
+    SolveRecorder<false> rec;
+    return conjugate_gradient(A, b, x, max_iter, tolerance, workspace, rec);
+}
+
+SolveReport solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                     CGWorkspace& workspace, SolveMonitor* monitor) {
+    SolveReport report;
+    SolveRecorder<true> rec(report, monitor);
+    conjugate_gradient(A, b, x, max_iter, tolerance, workspace, rec);
+    return report;
+}
+
+size_t solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                CGWorkspace& workspace, const CGVariantOptions& options) {
+    SolveRecorder<false> rec;
+    return run_cg_variant(A, b, x, max_iter, tolerance, workspace, options, rec);
+}
+
+SolveReport solve_cg(const LinearOperator& A, const Vector& b, Vector& x, size_t max_iter, double tolerance,
+                     CGWorkspace& workspace, const CGVariantOptions& options, SolveMonitor* monitor) {
+    SolveReport report;
+    SolveRecorder<true> rec(report, monitor);
+    run_cg_variant(A, b, x, max_iter, tolerance, workspace, options, rec);
+    return report;
+}
+
+Vector solve_pcg(const LinearOperator& A, const Vector& b, const Vector& x0, const Preconditioner& M,
+                 size_t max_iter, double tolerance) {
+    Vector x = x0;
+    CGWorkspace ws;
+    SolveRecorder<false> rec;
+    preconditioned_conjugate_gradient(A, b, x, M, max_iter, tolerance, ws, rec);
     return x;
 }
+
+size_t solve_pcg(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M,
+                 size_t max_iter, double tolerance, CGWorkspace& workspace) {
+    SolveRecorder<false> rec;
+    return preconditioned_conjugate_gradient(A, b, x, M, max_iter, tolerance, workspace, rec);
+}
+
+SolveReport solve_pcg(const LinearOperator& A, const Vector& b, Vector& x, const Preconditioner& M,
+                      size_t max_iter, double tolerance, CGWorkspace& workspace, SolveMonitor* monitor) {
+    SolveReport report;
+    SolveRecorder<true> rec(report, monitor);
+    preconditioned_conjugate_gradient(A, b, x, M, max_iter, tolerance, workspace, rec);
+    return report;
+}
@@ -17,11 +17,17 @@ Vector::Vector() : m_data() {} // Scope Resolution Operator
 
 // Constructor with size
 // Initialise m_data with specific 'size' and fills it with 0.0.
-Vector::Vector(size_t size) : m_data(size, 0.0) {} // Member Initialiser List
+// The allocator leaves the memory untouched, so the zeros are written in
+// parallel: every page is first touched by the thread that will use it.
+Vector::Vector(size_t size) : m_data(size) { // Member Initialiser List
+    parallel_fill(m_data.data(), size, 0.0);
+}
 
 // Constructor from std::vector
 // Copies the existing data from the input std::vector to our m_data.
-Vector::Vector(const std::vector<double>& data) : m_data(data) {}
+Vector::Vector(const std::vector<double>& data) : m_data(data.size()) {
+    parallel_copy(data.data(), m_data.data(), data.size());
+}
 
 // --- Section 2: Implementation of Destructor ---
 
@@ -35,7 +41,9 @@ Vector::~Vector() {}
 // 1. Copy Constructor
 // Purpose: Called when creating a new vector by copying an existing one (e.g., Vector v2 = v1;).
 // It ensures a deep copy of the internal data is made.
-Vector::Vector(const Vector& other) : m_data(other.m_data) {}
+Vector::Vector(const Vector& other) : m_data(other.m_data.size()) {
+    parallel_copy(other.m_data.data(), m_data.data(), other.m_data.size());
+}
 
 // 2. Copy Assignment Operator (using "Copy-and-Swap" Idiom)
 // Purpose: Called when assigning one existing vector to another (e.g., v2 = v1;).
@@ -82,6 +90,31 @@ size_t Vector::size() const {
     return m_data.size();
 }
 
+// Raw access to the contiguous storage
+// Hot loops use this to skip the bounds check in operator[]
+double* Vector::data() {
+    return m_data.data();
+}
+
+const double* Vector::data() const {
+    return m_data.data();
+}
+
+// Resize, zero-filling any new elements
+// std::vector keeps its capacity, so shrinking and re-growing does not reallocate
+void Vector::resize(size_t size) {
+    const size_t old_size = m_data.size();
+    m_data.resize(size);
+    if (size > old_size) {
+        parallel_fill(m_data.data() + old_size, size - old_size, 0.0);
+    }
+}
+
+// Copy into the existing buffer (operator= always builds a fresh copy first)
+void Vector::copyFrom(const Vector& other) {
+    m_data.assign(other.m_data.begin(), other.m_data.end());
+}
+
 // 2. Element Access (Read/Write)
 // Allow us to read or modify elements within the vector eg. v[0] = 5.0;
 double& Vector::operator[](size_t index) {
@@ -102,45 +135,63 @@ const double& Vector::operator[](size_t index) const {
     return m_data[index];
 }
 
-// 4. Vector Addition (v1 + v2)
-// Achieve addtion of vectors
-Vector Vector::operator+(const Vector& rhs) const {
-    // Check if size matches to achieve addition
-    if (size() != rhs.size()) {
-        throw std::length_error("Vectors must be of the same size to add.");
-    }
+// 4. Vector Addition, Subtraction and Scalar Multiplication
+// These are expression templates now and live in VectorExpression.hpp,
+// so there is nothing to implement here.
 
-    // Create a new result vector
-    Vector result(size());
+// --- Section 5: In-place BLAS-1 Kernels ---
+// These work directly on the raw arrays: no temporary vectors, no bounds checks
+// in the loop, and each vector is read (and written) exactly once.
 
-    // Add elements one by one
-    for (size_t i = 0; i < size(); ++i) {
-        result[i] = m_data[i] + rhs[i];
+// 1. axpy: this += alpha * x
+void Vector::axpy(double alpha, const Vector& x) {
+    if (size() != x.size()) {
+        throw std::length_error("Vectors must be of the same size for axpy.");
+    }
+    double* y = m_data.data();
+    const double* px = x.data();
+    const size_t n = size();
+    for (size_t i = 0; i < n; ++i) {
+        y[i] += alpha * px[i];
     }
-
-    return result;
 }
 
-// 5. Vector Subtraction (v1 - v2)
-// Achieve vector subtraction
-Vector Vector::operator-(const Vector& rhs) const {
-    if (size() != rhs.size()) {
-        throw std::length_error("Vectors must be of the same size to subtract.");
+// 2. xpay: this = x + beta * this
+void Vector::xpay(const Vector& x, double beta) {
+    if (size() != x.size()) {
+        throw std::length_error("Vectors must be of the same size for xpay.");
+    }
+    double* y = m_data.data();
+    const double* px = x.data();
+    const size_t n = size();
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = px[i] + beta * y[i];
     }
+}
 
-    Vector result(size());
-    for (size_t i = 0; i < size(); ++i) {
-        result[i] = m_data[i] - rhs[i];
+// 3. scale: this *= alpha
+void Vector::scale(double alpha) {
+    double* y = m_data.data();
+    const size_t n = size();
+    for (size_t i = 0; i < n; ++i) {
+        y[i] *= alpha;
     }
-    return result;
 }
 
-// 6. Scalar Multiplication (v1 * scalar)
-// Achieve multiplication of vector and scalar
-Vector Vector::operator*(double scalar) const {
-    Vector result(size());
-    for (size_t i = 0; i < size(); ++i) {
-        result[i] = m_data[i] * scalar;
+// 4. Fused axpy + dot: this += alpha * x, then return this · this
+// The updated value is still in a register, so the dot product costs no extra memory traffic.
+double Vector::axpyDot(double alpha, const Vector& x) {
+    if (size() != x.size()) {
+        throw std::length_error("Vectors must be of the same size for axpy.");
+    }
+    double* y = m_data.data();
+    const double* px = x.data();
+    const size_t n = size();
+    double dot = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double v = y[i] + alpha * px[i];
+        y[i] = v;
+        dot += v * v;
     }
-    return result;
+    return dot;
 }